@@ -0,0 +1,112 @@
+#include "compiledNet.h"
+
+namespace {
+
+//các mảng CSR do CompiledNet(const PetriNet&) tự xây
+struct OwnedArrays {
+    vector<int> preOffsets, postOffsets;
+    vector<IncidenceEntry> preEntries, postEntries;
+    vector<int> consumerOffsets, producerOffsets;
+    vector<int> consumerList, producerList;
+    vector<int> affectedOffsets, affectedList;
+};
+
+//gom danh sách (hàng, phần tử) thành CSR; phần tử trùng place trong cùng hàng được cộng trọng số
+void buildIncidenceCSR(int rows, vector<vector<IncidenceEntry>>& buckets,
+                       vector<int>& offsets, vector<IncidenceEntry>& entries) {
+    offsets.assign(rows + 1, 0);
+    entries.clear();
+    for (int r = 0; r < rows; r++) {
+        auto& row = buckets[r];
+        sort(row.begin(), row.end(), [](const IncidenceEntry& a, const IncidenceEntry& b) {
+            return a.place < b.place;
+        });
+        for (const auto& e : row) {
+            if (!entries.empty() && (int)entries.size() > offsets[r] && entries.back().place == e.place)
+                entries.back().weight += e.weight;
+            else
+                entries.push_back(e);
+        }
+        offsets[r + 1] = entries.size();
+        vector<IncidenceEntry>().swap(row);
+    }
+}
+
+//adjacency place -> transition (đảo ngược của incidence CSR)
+void buildAdjacencyCSR(int numPlaces, int numTransitions, const vector<int>& incOffsets,
+                       const vector<IncidenceEntry>& incEntries,
+                       vector<int>& offsets, vector<int>& list) {
+    offsets.assign(numPlaces + 1, 0);
+    for (const auto& e : incEntries) offsets[e.place + 1]++;
+    for (int p = 0; p < numPlaces; p++) offsets[p + 1] += offsets[p];
+    list.assign(incEntries.size(), 0);
+    vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (int t = 0; t < numTransitions; t++)
+        for (int k = incOffsets[t]; k < incOffsets[t + 1]; k++)
+            list[fill[incEntries[k].place]++] = t;
+}
+
+}
+
+CompiledNet::CompiledNet(const PetriNet& net) {
+    nPlaces = net.places.size();
+    nTransitions = net.transitions.size();
+
+    //id -> chỉ số qua bảng ký hiệu của net (id trùng: giữ phần tử đầu tiên, như findPlace())
+    SymbolTable scratch;
+    const SymbolTable& symbols = symbolsOf(net, scratch);
+    m0.resize(nPlaces);
+    for (int i = 0; i < nPlaces; i++)
+        m0[i] = net.places[i].initialMarking;
+
+    vector<vector<IncidenceEntry>> pre(nTransitions), post(nTransitions);
+    for (const auto& arc : net.arcs) {
+        int ps = symbols.place(arc.source);
+        int tt = symbols.transition(arc.target);
+        if (ps != -1 && tt != -1)
+            pre[tt].push_back({ps, arc.weight});
+
+        int ts = symbols.transition(arc.source);
+        int pt = symbols.place(arc.target);
+        if (ts != -1 && pt != -1)
+            post[ts].push_back({pt, arc.weight});
+    }
+
+    auto owned = make_shared<OwnedArrays>();
+    OwnedArrays& a = *owned;
+    buildIncidenceCSR(nTransitions, pre, a.preOffsets, a.preEntries);
+    buildIncidenceCSR(nTransitions, post, a.postOffsets, a.postEntries);
+    buildAdjacencyCSR(nPlaces, nTransitions, a.preOffsets, a.preEntries, a.consumerOffsets, a.consumerList);
+    buildAdjacencyCSR(nPlaces, nTransitions, a.postOffsets, a.postEntries, a.producerOffsets, a.producerList);
+
+    //affected(t) = hợp các consumers(p), p thuộc pre(t) ∪ post(t); stamp để loại trùng
+    a.affectedOffsets.assign(nTransitions + 1, 0);
+    vector<int> stamp(nTransitions, -1);
+    for (int t = 0; t < nTransitions; t++) {
+        auto collect = [&](const vector<int>& offsets, const vector<IncidenceEntry>& entries) {
+            for (int k = offsets[t]; k < offsets[t + 1]; k++) {
+                int p = entries[k].place;
+                for (int j = a.consumerOffsets[p]; j < a.consumerOffsets[p + 1]; j++) {
+                    int u = a.consumerList[j];
+                    if (stamp[u] != t) {
+                        stamp[u] = t;
+                        a.affectedList.push_back(u);
+                    }
+                }
+            }
+        };
+        collect(a.preOffsets, a.preEntries);
+        collect(a.postOffsets, a.postEntries);
+        a.affectedOffsets[t + 1] = a.affectedList.size();
+    }
+
+    csr = {a.preOffsets.data(), a.preEntries.data(), a.postOffsets.data(), a.postEntries.data(),
+           a.consumerOffsets.data(), a.consumerList.data(), a.producerOffsets.data(), a.producerList.data(),
+           a.affectedOffsets.data(), a.affectedList.data()};
+    storage = std::move(owned);
+}
+
+CompiledNet::CompiledNet(int numPlaces, int numTransitions, vector<int> initialMarking,
+                         const CompiledArrays& arrays, shared_ptr<const void> storage)
+    : nPlaces(numPlaces), nTransitions(numTransitions), m0(std::move(initialMarking)),
+      csr(arrays), storage(std::move(storage)) {}
@@ -0,0 +1,91 @@
+#ifndef COMPILED_NET_H
+#define COMPILED_NET_H
+
+#include "petriNet.h"
+#include <algorithm>
+#include <memory>
+
+//một phần tử incidence: place (chỉ số) và trọng số cung
+struct IncidenceEntry {
+    int place;
+    int weight;
+};
+
+//các mảng CSR của một CompiledNet, trỏ vào vùng nhớ chứa chúng (vector tự xây hoặc file cache được mmap)
+struct CompiledArrays {
+    const int* preOffsets;
+    const IncidenceEntry* preEntries;
+    const int* postOffsets;
+    const IncidenceEntry* postEntries;
+    const int* consumerOffsets;
+    const int* consumerList;
+    const int* producerOffsets;
+    const int* producerList;
+    const int* affectedOffsets;
+    const int* affectedList;
+};
+
+/*
+ * CompiledNet: cấu trúc mạng đã "biên dịch" sang chỉ số nguyên, xây đúng 1 lần từ PetriNet.
+ *
+ * - pre/post incidence của mỗi transition lưu dạng CSR (compressed sparse row):
+ *   pre(t) = preEntries[preOffsets[t] .. preOffsets[t+1]), post(t) tương tự.
+ * - adjacency place -> transition: consumers(p) là các transition lấy token từ p,
+ *   producers(p) là các transition đặt token vào p (cũng dạng CSR).
+ * - Nhiều cung song song giữa cùng 1 cặp (place, transition) được gộp trọng số.
+ *
+ * Đối tượng bất biến sau khi xây; mọi engine (BFS, BDD, ILP) đọc chung một bản.
+ * Các mảng CSR nằm trong storage dùng chung (copy CompiledNet không copy mảng); storage có thể
+ * là file cache được mmap (netCache.h), khi đó mảng được dùng tại chỗ, không giải tuần tự.
+ */
+class CompiledNet {
+public:
+    explicit CompiledNet(const PetriNet& net);
+    //mạng từ các mảng có sẵn; storage giữ vùng nhớ chứa arrays sống cùng đối tượng
+    CompiledNet(int numPlaces, int numTransitions, vector<int> initialMarking,
+                const CompiledArrays& arrays, shared_ptr<const void> storage);
+
+    int numPlaces() const { return nPlaces; }
+    int numTransitions() const { return nTransitions; }
+    const vector<int>& initialMarking() const { return m0; }
+    const CompiledArrays& arrays() const { return csr; }
+
+    const IncidenceEntry* preBegin(int t) const { return csr.preEntries + csr.preOffsets[t]; }
+    const IncidenceEntry* preEnd(int t) const { return csr.preEntries + csr.preOffsets[t + 1]; }
+    const IncidenceEntry* postBegin(int t) const { return csr.postEntries + csr.postOffsets[t]; }
+    const IncidenceEntry* postEnd(int t) const { return csr.postEntries + csr.postOffsets[t + 1]; }
+    int preSize(int t) const { return csr.preOffsets[t + 1] - csr.preOffsets[t]; }
+    int postSize(int t) const { return csr.postOffsets[t + 1] - csr.postOffsets[t]; }
+
+    const int* consumersBegin(int p) const { return csr.consumerList + csr.consumerOffsets[p]; }
+    const int* consumersEnd(int p) const { return csr.consumerList + csr.consumerOffsets[p + 1]; }
+    const int* producersBegin(int p) const { return csr.producerList + csr.producerOffsets[p]; }
+    const int* producersEnd(int p) const { return csr.producerList + csr.producerOffsets[p + 1]; }
+
+    //các transition có thể đổi trạng thái enabled sau khi t fire:
+    //consumer của mọi place trong pre(t) ∪ post(t), không trùng lặp
+    const int* affectedBegin(int t) const { return csr.affectedList + csr.affectedOffsets[t]; }
+    const int* affectedEnd(int t) const { return csr.affectedList + csr.affectedOffsets[t + 1]; }
+
+    //t có fire được tại marking tokens không
+    bool isEnabled(const int* tokens, int t) const {
+        for (const IncidenceEntry* e = preBegin(t); e != preEnd(t); ++e)
+            if (tokens[e->place] < e->weight) return false;
+        return true;
+    }
+    //ghi marking sau khi fire t vào out (out có thể trùng tokens)
+    void fire(const int* tokens, int* out, int t) const {
+        if (out != tokens) copy(tokens, tokens + nPlaces, out);
+        for (const IncidenceEntry* e = preBegin(t); e != preEnd(t); ++e) out[e->place] -= e->weight;
+        for (const IncidenceEntry* e = postBegin(t); e != postEnd(t); ++e) out[e->place] += e->weight;
+    }
+
+private:
+    int nPlaces;
+    int nTransitions;
+    vector<int> m0;
+    CompiledArrays csr;
+    shared_ptr<const void> storage;
+};
+
+#endif
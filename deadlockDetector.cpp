@@ -1,8 +1,11 @@
 #include "deadlockDetector.h"
+#include "invariants.h"
 #include <iostream>
 #include <chrono>
 #include <numeric>
 #include <algorithm>
+#include <map>
+#include <set>
 
 #include "ortools/linear_solver/linear_solver.h"
 
@@ -10,8 +13,9 @@ using namespace std;
 using namespace std::chrono;
 using namespace operations_research;
 
-DeadlockDetector::DeadlockDetector(const PetriNet& petriNet, SymbolicPetriNet& symNet)
-    : net(petriNet), symbolicNet(symNet), deadlockFound(false), detectionTime(0.0) {
+DeadlockDetector::DeadlockDetector(const PetriNet& petriNet, SymbolicPetriNet& symNet, DeadlockMethod method)
+    : net(petriNet), symbolicNet(symNet), method(method), deadlockFound(false), detectionTime(0.0),
+      deadReachableCount(0.0), cegarIterations(0), cutsAdded(0) {
     BDD_ops = symbolicNet.getBDDManager();
     deadlockFound = false;
     numPlaces = net.places.size();
@@ -22,18 +26,39 @@ DeadlockDetector::DeadlockDetector(const PetriNet& petriNet, SymbolicPetriNet& s
 
 DeadlockDetector::~DeadlockDetector() {}
 
-bool DeadlockDetector::isTransitionEnabled(int transitionIdx, const vector<int>& marking) {
-    string transId = net.transitions[transitionIdx].id;
-    for (const auto& arc : net.arcs) {
-        if (arc.target == transId) { // Arc P -> T
-            int pIdx = -1;
-            for(size_t i=0; i<net.places.size(); ++i) {
-                if(net.places[i].id == arc.source) { pIdx = i; break; }
-            }
-            if (pIdx != -1 && marking[pIdx] < 1) return false;
-        }
+bool DeadlockDetector::detectDeadlock() {
+    auto start = high_resolution_clock::now();
+    bool found = method == DeadlockMethod::Symbolic ? detectDeadlockSymbolic() : detectDeadlockIlp();
+    detectionTime = duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
+    return found;
+}
+
+/*
+ * Tìm deadlock thuần BDD, không cần ILP:
+ *   Dead = ∧_t ¬enabled_t  (enabled_t: mọi input place đủ token)
+ *   Dead ∧ reachableStates  -> rỗng: không có deadlock, ngược lại lấy 1 minterm làm witness.
+ * Chỉ một phép AND sau khi đã có reachableStates, không phụ thuộc số marking chết unreachable.
+ */
+bool DeadlockDetector::detectDeadlockSymbolic() {
+    std::cout << "[Task 4] Bat dau tim deadlock (BDD)..." << std::endl;
+
+    DdNode* dead = symbolicNet.deadStates();
+    DdNode* deadReachable = Cudd_bddAnd(BDD_ops, dead, symbolicNet.getReachableStates());
+    Cudd_Ref(deadReachable);
+    Cudd_RecursiveDeref(BDD_ops, dead);
+
+    deadReachableCount = Cudd_CountMinterm(BDD_ops, deadReachable, symbolicNet.getNumCurrentVars());
+    vector<int> witness;
+    deadlockFound = symbolicNet.pickMarking(deadReachable, witness);
+    Cudd_RecursiveDeref(BDD_ops, deadReachable);
+
+    if (deadlockFound) {
+        deadlockMarking.tokens = witness;
+        std::cout << "[Task 4] DA TIM THAY DEADLOCK (" << deadReachableCount << " marking chet reachable)." << std::endl;
+    } else {
+        std::cout << "[Task 4] Khong co marking chet nao reachable." << std::endl;
     }
-    return true;
+    return deadlockFound;
 }
 
 /*
@@ -43,9 +68,7 @@ bool DeadlockDetector::isTransitionEnabled(int transitionIdx, const vector<int>&
  * - Có: Deadlock thật -> Return True.
  * - Không: M là spurious (giả). Thêm constraint vào ILP để loại bỏ M. Quay lại B1.
  */
-bool DeadlockDetector::detectDeadlock() {
-    // đo runtime
-    auto start = high_resolution_clock::now();
+bool DeadlockDetector::detectDeadlockIlp() {
     std::cout << "[Task 4] Bat dau tim deadlock (ILP + BDD)..." << std::endl;
 
     std::unique_ptr<MPSolver> solver(MPSolver::CreateSolver("SCIP"));
@@ -60,33 +83,32 @@ bool DeadlockDetector::detectDeadlock() {
     }
 
     // tạo VARIABLES cho PETRI
-    // Mỗi Place p tương ứng với một biến x_p trong bài toán ILP.
-    // Vì mạng là 1-safe (theo đề bài), số token tại mỗi place chỉ có thể là 0 hoặc 1.
-    // Do đó, ta tạo biến nhị phân (Integer Var từ 0 đến 1).
+    // Mỗi Place p tương ứng với một biến nguyên x_p trong bài toán ILP, 0 <= x_p <= bound của place
+    // trong mã hóa BDD: mạng 1-safe (theo đề bài) => biến nhị phân như cũ, mã hóa k-bounded => 0..k.
+    const CompiledNet& compiled = symbolicNet.getCompiledNet();
+    bool safe = symbolicNet.isSafeEncoding();
     std::vector<MPVariable*> vars;
     for (int i = 0; i < numPlaces; ++i) {
         // Biến x_0, x_1, ... tương ứng với token tại Place 0, Place 1...
-        vars.push_back(solver->MakeIntVar(0.0, 1.0, "x_" + std::to_string(i)));
+        vars.push_back(solver->MakeIntVar(0.0, symbolicNet.getPlaceBound(i), "x_" + std::to_string(i)));
     }
 
     // Một trạng thái là "Dead" nếu KHÔNG CÓ transition nào kích hoạt được (disabled).
-    // Transition t bị disable khi: Tổng số token ở các Input Place < Tổng trọng số cung đầu vào.
-    // Công thức: Sum(weight * x_p) <= TotalInputWeight - 1
-    
-    for (const auto& t : net.transitions) {
+    // Transition t bị disable khi: có ít nhất 1 Input Place p mà x_p < weight(p, t).
+    // (Mã hóa 1-safe bỏ qua trọng số như transition relation của BDD: weight coi như 1.)
+    for (int t = 0; t < numTransitions; ++t) {
         double totalInputWeight = 0;
+        bool binaryRow = true;    // mọi input place có bound đúng bằng weight
+        bool neverEnabled = false; // có input place không bao giờ chứa đủ weight token
         std::vector<std::pair<int, double>> inputPlaces;
 
-        // Duyệt qua các cung (arc) để tìm Input Places của transition t
-        for (const auto& arc : net.arcs) {
-            if (arc.target == t.id) { // Nếu cung đi vào t
-                int pIdx = findPlace(net.places, arc.source);
-                if (pIdx != -1) {
-                    double w = (double)arc.weight;
-                    inputPlaces.push_back({pIdx, w});
-                    totalInputWeight += w;
-                }
-            }
+        // Input Places của transition t lấy thẳng từ pre-incidence (CSR) của CompiledNet
+        for (const IncidenceEntry* e = compiled.preBegin(t); e != compiled.preEnd(t); ++e) {
+            double w = safe ? 1.0 : (double)e->weight;
+            inputPlaces.push_back({e->place, w});
+            totalInputWeight += w;
+            if (symbolicNet.getPlaceBound(e->place) < w) neverEnabled = true;
+            if (symbolicNet.getPlaceBound(e->place) != w) binaryRow = false;
         }
 
         // Nếu transition không có đầu vào -> Luôn enabled -> Mạng không bao giờ deadlock.
@@ -94,23 +116,93 @@ bool DeadlockDetector::detectDeadlock() {
             continue; 
         }
 
-        // Tạo constraint cho transition t:
-        // Ví dụ: t cần p1 + p2 >= 2 để chạy. Muốn t disable thì p1 + p2 <= 1.
-        // MakeRowConstraint tạo biểu thức: -vocung <= ... <= (totalWeight - 1)
-        MPConstraint* ct = solver->MakeRowConstraint(-MPSolver::infinity(), totalInputWeight - 1.0);
-        
-        // Thêm hệ số cho các biến vào constraint
+        // bound_p < weight: t luôn disabled trong mã hóa, không cần ràng buộc nào
+        if (neverEnabled) {
+            continue;
+        }
+
+        if (binaryRow) {
+            // Mọi x_p <= weight_p: t enabled <=> mọi x_p = weight_p <=> Sum(x_p) = TotalInputWeight.
+            // Ví dụ: t cần p1 >= 2 và p2 >= 1 (bound 2 và 1). Muốn t disable thì p1 + p2 <= 2.
+            // Hệ số phải là 1: hệ số weight sẽ loại cả marking chết có 0 < x_p < weight.
+            // MakeRowConstraint tạo biểu thức: -vocung <= ... <= (totalWeight - 1)
+            MPConstraint* ct = solver->MakeRowConstraint(-MPSolver::infinity(), totalInputWeight - 1.0);
+            
+            // Thêm hệ số cho các biến vào constraint
+            for (const auto& input : inputPlaces) {
+                ct->SetCoefficient(vars[input.first], 1.0);
+            }
+            continue;
+        }
+
+        // Place có thể giữ nhiều token hơn weight: chọn (biến nhị phân y_p) place nào thiếu token.
+        //   Sum(y_p) >= 1,   x_p <= (w_p - 1) + (bound_p - w_p + 1) * (1 - y_p)
+        MPConstraint* choose = solver->MakeRowConstraint(1.0, MPSolver::infinity());
         for (const auto& input : inputPlaces) {
-            ct->SetCoefficient(vars[input.first], input.second);
+            int p = input.first;
+            double big = symbolicNet.getPlaceBound(p) - input.second + 1.0;
+            MPVariable* y = solver->MakeBoolVar("short_" + std::to_string(t) + "_" + std::to_string(p));
+            choose->SetCoefficient(y, 1.0);
+            MPConstraint* ct = solver->MakeRowConstraint(-MPSolver::infinity(), input.second - 1.0 + big);
+            ct->SetCoefficient(vars[p], 1.0);
+            ct->SetCoefficient(y, big);
         }
     }
 
+    // PHƯƠNG TRÌNH TRẠNG THÁI: M = M0 + C·σ, σ_t >= 0 nguyên (số lần fire t).
+    // Mọi marking reachable thỏa mãn nó, nên candidate vi phạm (phần lớn marking chết giả,
+    // ví dụ vi phạm bảo toàn token) bị loại ngay trong solver thay vì qua vòng BDD.
+    // Chỉ đúng khi tập reachable của BDD trùng với mạng thật (không có firing bị mã hóa cắt/gộp).
+    bool exact = symbolicNet.isExactModel();
+    if (exact) {
+        std::vector<MPConstraint*> rows;
+        for (int p = 0; p < numPlaces; ++p) {
+            // x_p - Sum_t C[p][t] * σ_t = M0[p]
+            double m0 = compiled.initialMarking()[p];
+            rows.push_back(solver->MakeRowConstraint(m0, m0));
+            rows[p]->SetCoefficient(vars[p], 1.0);
+        }
+        std::map<int, double> effect; // place -> C[p][t]
+        for (int t = 0; t < numTransitions; ++t) {
+            effect.clear();
+            for (const IncidenceEntry* e = compiled.preBegin(t); e != compiled.preEnd(t); ++e) effect[e->place] -= e->weight;
+            for (const IncidenceEntry* e = compiled.postBegin(t); e != compiled.postEnd(t); ++e) effect[e->place] += e->weight;
+            MPVariable* sigma = solver->MakeIntVar(0.0, MPSolver::infinity(), "sigma_" + std::to_string(t));
+            for (const auto& pe : effect) {
+                if (pe.second != 0) rows[pe.first]->SetCoefficient(sigma, -pe.second);
+            }
+        }
+        std::cout << "[Task 4] Them phuong trinh trang thai M = M0 + C.sigma (" << numTransitions << " bien sigma)" << std::endl;
+    } else {
+        std::cout << "[Task 4] Bo qua phuong trinh trang thai: ma hoa BDD khong khop mang that "
+                  << "(mang khong 1-safe hoac vuot bound)" << std::endl;
+    }
+
+    // P-INVARIANT: Sum(y_p * x_p) = Sum(y_p * M0[p]) với mỗi y của computePInvariants().
+    // Với mô hình chính xác chúng suy ra được từ phương trình trạng thái nhưng vẫn thêm tường minh
+    // cho solver; khi không có phương trình trạng thái đây là ràng buộc bảo toàn duy nhất.
+    // Mã hóa không chính xác (token bị gộp/cắt) có thể phá invariant => chỉ thêm invariant mà
+    // mọi marking trong reachableStates của BDD thỏa mãn, nếu không sẽ loại mất deadlock thật của mô hình.
+    InvariantResult pInvariants = computePInvariants(compiled);
+    int invariantRows = 0;
+    for (const Invariant& inv : pInvariants.invariants) {
+        long long total = 0;
+        for (const auto& entry : inv.entries) total += entry.second * compiled.initialMarking()[entry.first];
+        if (!exact && !symbolicNet.holdsOnReachable(inv.entries, total)) continue;
+        MPConstraint* ct = solver->MakeRowConstraint((double)total, (double)total);
+        for (const auto& entry : inv.entries) ct->SetCoefficient(vars[entry.first], (double)entry.second);
+        invariantRows++;
+    }
+    std::cout << "[Task 4] Them " << invariantRows << "/" << pInvariants.invariants.size()
+              << " rang buoc P-invariant" << std::endl;
+
     // CEGAR (TÌM KIẾM - KIỂM TRA - LOẠI BỎ)
     bool foundRealDeadlock = false;
 
     while (true) {
         // giải ILP để tìm một "Candidate Deadlock" (Trạng thái chết tiềm năng)
         MPSolver::ResultStatus resultStatus = solver->Solve();
+        cegarIterations++;
 
         // Nếu Solver không tìm ra nghiệm -> Không còn trạng thái chết nào -> Hệ thống an toàn.
         if (resultStatus != MPSolver::OPTIMAL && resultStatus != MPSolver::FEASIBLE) {
@@ -120,12 +212,9 @@ bool DeadlockDetector::detectDeadlock() {
 
         // lấy nghiệm TỪ SOLVER
         std::vector<int> candidate(numPlaces);
-        int activeTokens = 0; // Đếm số lượng place có token (giá trị = 1)
         for (int i = 0; i < numPlaces; ++i) {
             // Lấy giá trị biến x_i 
-            int val = (int)(vars[i]->solution_value() + 0.5);
-            candidate[i] = val;
-            if (val > 0) activeTokens++;
+            candidate[i] = (int)(vars[i]->solution_value() + 0.5);
         }
 
         // check REACHABILITY = BDD (Task 3)
@@ -139,33 +228,84 @@ bool DeadlockDetector::detectDeadlock() {
             break; // Thoát vòng lặp ngay lập tức
         } else {
             // === case 2: DEADLOCK GIẢ (SPURIOUS) ===
-            std::cout << "[Task 4] Phat hien Spurious Deadlock (Unreachable). Them rang buoc loai bo..." << std::endl;
-            // Mục tiêu: Bắt buộc Solver lần sau KHÔNG ĐƯỢC trả về đúng bộ (x_0...x_n) này nữa.
-            // Công thức Canonical Cut cho biến nhị phân:
-            // (Tổng các biến đang bằng 1) - (Tổng các biến đang bằng 0) <= (Số lượng biến bằng 1) - 1
-            // Ý nghĩa: Ít nhất 1 biến phải đảo giá trị (0->1 hoặc 1->0).
-            
-            MPConstraint* cut = solver->MakeRowConstraint(-MPSolver::infinity(), activeTokens - 1.0);
-            for (int i = 0; i < numPlaces; ++i) {
-                if (candidate[i] > 0) {
-                    // Nếu biến này đang là 1 trong candidate, hệ số là +1
-                    cut->SetCoefficient(vars[i], 1.0);
-                } else {
-                    // Nếu biến này đang là 0 trong candidate, hệ số là -1
-                    cut->SetCoefficient(vars[i], -1.0);
+            // Không chỉ loại đúng 1 nghiệm: dùng BDD thu nhỏ candidate thành các cube (tập literal
+            // x_p = 0/1) mà MỌI marking trong cube đều unreachable, rồi cấm cả cube.
+            // Cube chỉ cố định k place => loại 2^(n-k) nghiệm cùng lúc.
+            vector<vector<char>> cubes = generalizeSpurious(candidate);
+            std::cout << "[Task 4] Phat hien Spurious Deadlock (Unreachable). Them " << cubes.size()
+                      << " rang buoc loai bo (so literal:";
+            for (const vector<char>& fixed : cubes) {
+                // Cut cho cube: ít nhất 1 place trong cube phải đổi giá trị.
+                // Place nhị phân: (Tổng x_p đang bằng 1) - (Tổng x_p đang bằng 0) <= (Số literal bằng 1) - 1
+                // Place nhiều token (x_p = v): thêm biến nhị phân "x_p khác v" vào vế trái với hệ số -1.
+                int ones = 0, literals = 0;
+                for (int i = 0; i < numPlaces; ++i) {
+                    if (!fixed[i]) continue;
+                    literals++;
+                    if (symbolicNet.getPlaceBound(i) == 1 && candidate[i] > 0) ones++;
                 }
+                MPConstraint* cut = solver->MakeRowConstraint(-MPSolver::infinity(), ones - 1.0);
+                for (int i = 0; i < numPlaces; ++i) {
+                    if (!fixed[i]) continue;
+                    int bound = symbolicNet.getPlaceBound(i);
+                    int v = candidate[i];
+                    if (bound == 1) {
+                        // Nếu biến này đang là 1 trong candidate, hệ số là +1, đang là 0 thì -1
+                        cut->SetCoefficient(vars[i], v > 0 ? 1.0 : -1.0);
+                        continue;
+                    }
+                    if (v < bound) { // up = 1 => x_i >= v + 1
+                        MPVariable* up = solver->MakeBoolVar("");
+                        MPConstraint* ct = solver->MakeRowConstraint(0.0, MPSolver::infinity());
+                        ct->SetCoefficient(vars[i], 1.0);
+                        ct->SetCoefficient(up, -(v + 1.0));
+                        cut->SetCoefficient(up, -1.0);
+                    }
+                    if (v > 0) {     // down = 1 => x_i <= v - 1
+                        MPVariable* down = solver->MakeBoolVar("");
+                        MPConstraint* ct = solver->MakeRowConstraint(-MPSolver::infinity(), bound);
+                        ct->SetCoefficient(vars[i], 1.0);
+                        ct->SetCoefficient(down, bound - v + 1.0);
+                        cut->SetCoefficient(down, -1.0);
+                    }
+                }
+                cutsAdded++;
+                std::cout << " " << literals;
             }
-            // Solver tìm nghiệm khác tránh nghiệm vừa loại bỏ.
+            std::cout << ")" << std::endl;
+            // Solver tìm nghiệm khác, tránh mọi cube vừa loại bỏ.
         }
     }
 
-    auto stop = high_resolution_clock::now();
-    auto duration = duration_cast<milliseconds>(stop - start);
-    detectionTime = duration.count();
-
     return foundRealDeadlock;
 }
 
+/*
+ * Tổng quát hóa một candidate spurious (unreachable) thành các cube unreachable nhỏ.
+ * Bỏ dần từng literal theo một thứ tự duyệt place; literal nào bỏ đi mà cube vẫn không chứa
+ * marking reachable nào thì bỏ hẳn. Mỗi thứ tự cho ra một cube tối tiểu (không bỏ thêm được
+ * literal nào), các thứ tự khác nhau cho các cube khác nhau => nhiều cut trong một vòng.
+ */
+vector<vector<char>> DeadlockDetector::generalizeSpurious(const vector<int>& candidate) {
+    vector<int> forward(numPlaces);
+    iota(forward.begin(), forward.end(), 0);
+    vector<int> backward(forward.rbegin(), forward.rend());
+    vector<int> zerosFirst = forward, onesFirst = forward;
+    stable_partition(zerosFirst.begin(), zerosFirst.end(), [&](int p) { return candidate[p] == 0; });
+    stable_partition(onesFirst.begin(), onesFirst.end(), [&](int p) { return candidate[p] > 0; });
+
+    set<vector<char>> cubes;
+    for (const vector<int>* order : {&forward, &backward, &zerosFirst, &onesFirst}) {
+        vector<char> fixed(numPlaces, 1);
+        for (int p : *order) {
+            fixed[p] = 0;
+            if (symbolicNet.containsAny(candidate, fixed)) fixed[p] = 1; //cần literal này
+        }
+        cubes.insert(fixed);
+    }
+    return vector<vector<char>>(cubes.begin(), cubes.end());
+}
+
 void DeadlockDetector::printResults() {
     std::cout << "========== TASK 4: DEADLOCK DETECTION ==========" << std::endl;
     if (deadlockFound) {
@@ -178,9 +318,15 @@ void DeadlockDetector::printResults() {
             }
         }
         std::cout << "]" << std::endl;
+        if (method == DeadlockMethod::Symbolic) {
+            std::cout << "Reachable dead markings: " << deadReachableCount << std::endl;
+        }
     } else {
         std::cout << "No deadlock found." << std::endl;
     }
+    if (method == DeadlockMethod::IlpCegar) {
+        std::cout << "CEGAR iterations: " << cegarIterations << " (" << cutsAdded << " cuts)" << std::endl;
+    }
     std::cout << "===================================================" << std::endl;
 }
 
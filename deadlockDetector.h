@@ -8,9 +8,16 @@
 #include <string>
 #include <map>
 
+//cách tìm deadlock
+enum class DeadlockMethod {
+    IlpCegar, //ILP đề xuất marking chết, BDD kiểm tra reachable, cắt nghiệm giả rồi lặp lại
+    Symbolic  //BDD: (∧_t ¬enabled_t) ∧ reachableStates, lấy 1 witness bằng Cudd_bddPickOneMinterm
+};
+
 class DeadlockDetector {
 public:
-    DeadlockDetector(const PetriNet& petriNet, SymbolicPetriNet& symNet);
+    DeadlockDetector(const PetriNet& petriNet, SymbolicPetriNet& symNet,
+                     DeadlockMethod method = DeadlockMethod::IlpCegar);
     ~DeadlockDetector();
     bool detectDeadlock();
     void printResults();
@@ -20,15 +27,21 @@ private:
     const PetriNet& net;                    
     SymbolicPetriNet& symbolicNet;          
     DdManager* BDD_ops;                     
+    DeadlockMethod method;
     
     Marking deadlockMarking;
     bool deadlockFound;                      
     double detectionTime;     
+    double deadReachableCount; //số marking chết reachable (chỉ chế độ Symbolic)
+    int cegarIterations;       //số lần giải ILP (chỉ chế độ IlpCegar)
+    int cutsAdded;
     
     int numPlaces;
     int numTransitions;
 
-    bool isTransitionEnabled(int transitionIdx, const vector<int>& marking);
+    bool detectDeadlockIlp();
+    vector<vector<char>> generalizeSpurious(const vector<int>& candidate);
+    bool detectDeadlockSymbolic();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef EXPLICIT_MODELS_H
+#define EXPLICIT_MODELS_H
+
+#include "compiledNet.h"
+#include "packedNet.h"
+
+/*
+ * Hai cách biểu diễn marking cho các engine tường minh (BFS, parallelBFS).
+ * Cùng giao diện: Word, width(), numTransitions(), initial(), isEnabled(), fire(), decode().
+ * fire() trả về false khi firing không biểu diễn được (PackedModel: mạng không 1-safe).
+ */
+
+//marking vector<int>, dùng cho mọi mạng
+struct IntModel {
+    typedef int Word;
+    const CompiledNet& net;
+    explicit IntModel(const CompiledNet& n) : net(n) {}
+    int width() const { return net.numPlaces(); }
+    int numTransitions() const { return net.numTransitions(); }
+    void initial(Word* out) const { copy(net.initialMarking().begin(), net.initialMarking().end(), out); }
+    bool isEnabled(const Word* m, int t) const { return net.isEnabled(m, t); }
+    bool fire(const Word* m, Word* out, int t) const { net.fire(m, out, t); return true; }
+    void decode(const Word* m, Marking& M) const { M.tokens.assign(m, m + width()); }
+};
+
+//marking bit-packed cho mạng 1-safe
+struct PackedModel {
+    typedef uint64_t Word;
+    const CompiledNet& compiled;
+    PackedNet net;
+    explicit PackedModel(const CompiledNet& n) : compiled(n), net(n) {}
+    int width() const { return net.numWords(); }
+    int numTransitions() const { return net.numTransitions(); }
+    void initial(Word* out) const { net.pack(compiled.initialMarking().data(), out); }
+    bool isEnabled(const Word* m, int t) const { return net.isEnabled(m, t); }
+    bool fire(const Word* m, Word* out, int t) const { return net.fire(m, out, t); }
+    void decode(const Word* m, Marking& M) const {
+        M.tokens.resize(net.numPlaces());
+        net.unpack(m, M.tokens.data());
+    }
+};
+
+#endif
@@ -0,0 +1,301 @@
+#include "invariants.h"
+#include <climits>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+
+namespace {
+
+typedef vector<pair<int, long long>> SparseRow; //(cột, hệ số != 0), tăng dần theo cột
+
+//một dòng của bảng Farkas: left = tổ hợp các phần tử ban đầu, right = phần dư chưa khử
+struct Row {
+    SparseRow left;
+    SparseRow right;
+    vector<uint64_t> bits; //support của left
+    int supportSize;
+};
+
+long long coefficientAt(const SparseRow& row, int col) {
+    auto it = lower_bound(row.begin(), row.end(), col,
+                          [](const pair<int, long long>& e, int c) { return e.first < c; });
+    return (it != row.end() && it->first == col) ? it->second : 0;
+}
+
+//ma*a + mb*b, false nếu tràn 64-bit
+bool combine(const SparseRow& a, long long ma, const SparseRow& b, long long mb, SparseRow& out) {
+    out.clear();
+    size_t i = 0, j = 0;
+    while (i < a.size() || j < b.size()) {
+        int col;
+        __int128 v = 0;
+        if (j == b.size() || (i < a.size() && a[i].first < b[j].first)) {
+            col = a[i].first;
+            v = (__int128)a[i++].second * ma;
+        } else if (i == a.size() || b[j].first < a[i].first) {
+            col = b[j].first;
+            v = (__int128)b[j++].second * mb;
+        } else {
+            col = a[i].first;
+            v = (__int128)a[i++].second * ma + (__int128)b[j++].second * mb;
+        }
+        if (v > LLONG_MAX || v < -LLONG_MAX) return false;
+        if (v != 0) out.push_back({col, (long long)v});
+    }
+    return true;
+}
+
+void divideByGcd(Row& r) {
+    long long g = 0;
+    for (const auto& e : r.left) g = gcd(g, e.second < 0 ? -e.second : e.second);
+    for (const auto& e : r.right) g = gcd(g, e.second < 0 ? -e.second : e.second);
+    if (g <= 1) return;
+    for (auto& e : r.left) e.second /= g;
+    for (auto& e : r.right) e.second /= g;
+}
+
+//support của small nằm trong support của big: duyệt phần tử của small, tra bitset của big
+bool isSubset(const Row& small, const Row& big) {
+    if (small.supportSize > big.supportSize) return false;
+    for (const auto& e : small.left)
+        if (!(big.bits[e.first / 64] >> (e.first % 64) & 1)) return false;
+    return true;
+}
+
+/*
+ * Farkas trên ma trận thưa matrix (numItems dòng, numCols cột): mọi y >= 0 có support tối tiểu
+ * với yᵀ·matrix = 0.
+ *
+ * Dòng nằm trong pool với chỉ số cố định (dòng bị khử chỉ đánh dấu chết), nên mỗi bước chỉ đụng
+ * tới các dòng có hệ số khác 0 ở cột khử và các tổ hợp mới:
+ *  - byColumn[c]: các dòng từng có phần dư khác 0 ở cột c (lọc dòng chết khi duyệt)
+ *  - byFirst[i]:  các dòng sống có phần tử nhỏ nhất của support là i; dòng con của r chỉ có thể
+ *                 nằm ở byFirst của một phần tử thuộc support của r
+ *  - positive/negative: số dòng sống có hệ số dương/âm ở mỗi cột, cập nhật tăng dần
+ * Dòng cũ còn sống không thể bị tổ hợp mới bao (tổ hợp chứa support của một dòng cũ đã tối tiểu),
+ * nên chỉ cần kiểm tra tổ hợp mới với dòng cũ và với các tổ hợp nhỏ hơn đã giữ.
+ */
+InvariantResult farkas(const vector<SparseRow>& matrix, int numCols, const InvariantOptions& options) {
+    InvariantResult result;
+    int numItems = matrix.size();
+    size_t words = (numItems + 63) / 64;
+
+    vector<Row> pool;
+    vector<char> alive;
+    vector<vector<size_t>> byColumn(numCols), byFirst(numItems);
+    vector<int> positive(numCols, 0), negative(numCols, 0);
+    size_t aliveCount = 0;
+
+    auto addRow = [&](Row&& r) {
+        size_t id = pool.size();
+        for (const auto& e : r.right) {
+            byColumn[e.first].push_back(id);
+            (e.second > 0 ? positive : negative)[e.first]++;
+        }
+        byFirst[r.left.front().first].push_back(id);
+        pool.push_back(std::move(r));
+        alive.push_back(1);
+        aliveCount++;
+    };
+    auto killRow = [&](size_t id) {
+        for (const auto& e : pool[id].right) (e.second > 0 ? positive : negative)[e.first]--;
+        alive[id] = 0;
+        aliveCount--;
+    };
+    auto dominated = [&](const Row& r) {
+        for (const auto& e : r.left) {
+            vector<size_t>& bucket = byFirst[e.first];
+            size_t out = 0;
+            bool found = false;
+            for (size_t k : bucket) {
+                if (!alive[k]) continue; //dọn dòng chết luôn khi duyệt
+                bucket[out++] = k;
+                if (!found && isSubset(pool[k], r)) found = true;
+            }
+            bucket.resize(out);
+            if (found) return true;
+        }
+        return false;
+    };
+
+    for (int i = 0; i < numItems; i++) {
+        Row r;
+        r.left = {{i, 1}};
+        r.right = matrix[i];
+        r.bits.assign(words, 0);
+        r.bits[i / 64] |= 1ULL << (i % 64);
+        r.supportSize = 1;
+        addRow(std::move(r));
+    }
+
+    while (true) {
+        //chọn cột khử: ít dòng mới nhất (pos·neg - pos - neg)
+        int col = -1;
+        long long bestCost = LLONG_MAX;
+        for (int c = 0; c < numCols; c++) {
+            if (!positive[c] && !negative[c]) continue;
+            long long cost = (long long)positive[c] * negative[c] - positive[c] - negative[c];
+            if (cost < bestCost) {
+                bestCost = cost;
+                col = c;
+            }
+        }
+        if (col < 0) break; //mọi phần dư đã bằng 0
+
+        vector<size_t> pos, neg;
+        for (size_t id : byColumn[col]) {
+            if (!alive[id]) continue;
+            long long v = coefficientAt(pool[id].right, col);
+            if (v > 0) pos.push_back(id);
+            else if (v < 0) neg.push_back(id);
+        }
+        byColumn[col].clear(); //sau bước này không dòng sống nào còn hệ số ở cột col
+        for (size_t id : pos) killRow(id);
+        for (size_t id : neg) killRow(id);
+
+        vector<Row> combos;
+        for (size_t a : pos) {
+            long long ca = coefficientAt(pool[a].right, col);
+            for (size_t b : neg) {
+                long long cb = -coefficientAt(pool[b].right, col);
+                long long g = gcd(ca, cb);
+                Row r;
+                //cb·a + ca·b triệt tiêu cột col
+                if (!combine(pool[a].left, cb / g, pool[b].left, ca / g, r.left) ||
+                    !combine(pool[a].right, cb / g, pool[b].right, ca / g, r.right)) {
+                    result.complete = false;
+                    continue;
+                }
+                r.bits.resize(words);
+                r.supportSize = 0;
+                for (size_t w = 0; w < words; w++) {
+                    r.bits[w] = pool[a].bits[w] | pool[b].bits[w];
+                    r.supportSize += __builtin_popcountll(r.bits[w]);
+                }
+                divideByGcd(r);
+                combos.push_back(std::move(r));
+            }
+        }
+        for (size_t id : pos) pool[id] = Row(); //giải phóng bộ nhớ dòng chết
+        for (size_t id : neg) pool[id] = Row();
+
+        //theo support tăng dần: tổ hợp giữ lại không thể bị tổ hợp xét sau bao (trùng support thì giữ cái đầu)
+        stable_sort(combos.begin(), combos.end(),
+                    [](const Row& a, const Row& b) { return a.supportSize < b.supportSize; });
+        for (Row& r : combos) {
+            if (!dominated(r)) addRow(std::move(r));
+        }
+
+        if (aliveCount > options.maxRows) {
+            result.complete = false;
+            return result;
+        }
+    }
+
+    for (size_t id = 0; id < pool.size(); id++) {
+        if (alive[id]) result.invariants.push_back({std::move(pool[id].left)});
+    }
+    return result;
+}
+
+//C[p][t] theo từng transition: (place, post - pre) khác 0, tăng dần theo place
+vector<SparseRow> transitionEffects(int numPlaces, const vector<vector<pair<int,int>>>& inArcs,
+                                    const vector<vector<pair<int,int>>>& outArcs) {
+    vector<SparseRow> effects(inArcs.size());
+    vector<long long> delta(numPlaces, 0);
+    for (size_t t = 0; t < inArcs.size(); t++) {
+        vector<int> touched;
+        for (const auto& a : inArcs[t]) { touched.push_back(a.first); delta[a.first] -= a.second; }
+        for (const auto& a : outArcs[t]) { touched.push_back(a.first); delta[a.first] += a.second; }
+        sort(touched.begin(), touched.end());
+        touched.erase(unique(touched.begin(), touched.end()), touched.end());
+        for (int p : touched) {
+            if (delta[p] != 0) effects[t].push_back({p, delta[p]});
+            delta[p] = 0;
+        }
+    }
+    return effects;
+}
+
+void compiledTables(const CompiledNet& net, vector<vector<pair<int,int>>>& inArcs,
+                    vector<vector<pair<int,int>>>& outArcs) {
+    inArcs.assign(net.numTransitions(), {});
+    outArcs.assign(net.numTransitions(), {});
+    for (int t = 0; t < net.numTransitions(); t++) {
+        for (const IncidenceEntry* e = net.preBegin(t); e != net.preEnd(t); ++e) inArcs[t].push_back({e->place, e->weight});
+        for (const IncidenceEntry* e = net.postBegin(t); e != net.postEnd(t); ++e) outArcs[t].push_back({e->place, e->weight});
+    }
+}
+
+}
+
+InvariantResult computePInvariants(int numPlaces, const vector<vector<pair<int,int>>>& inArcs,
+                                   const vector<vector<pair<int,int>>>& outArcs,
+                                   const InvariantOptions& options) {
+    //dòng p của ma trận = C[p][·]
+    vector<SparseRow> effects = transitionEffects(numPlaces, inArcs, outArcs);
+    vector<SparseRow> rows(numPlaces);
+    for (size_t t = 0; t < effects.size(); t++)
+        for (const auto& e : effects[t]) rows[e.first].push_back({(int)t, e.second});
+    return farkas(rows, effects.size(), options);
+}
+
+InvariantResult computeTInvariants(int numPlaces, const vector<vector<pair<int,int>>>& inArcs,
+                                   const vector<vector<pair<int,int>>>& outArcs,
+                                   const InvariantOptions& options) {
+    //dòng t của ma trận = C[·][t]
+    return farkas(transitionEffects(numPlaces, inArcs, outArcs), numPlaces, options);
+}
+
+InvariantResult computePInvariants(const CompiledNet& net, const InvariantOptions& options) {
+    vector<vector<pair<int,int>>> inArcs, outArcs;
+    compiledTables(net, inArcs, outArcs);
+    return computePInvariants(net.numPlaces(), inArcs, outArcs, options);
+}
+
+InvariantResult computeTInvariants(const CompiledNet& net, const InvariantOptions& options) {
+    vector<vector<pair<int,int>>> inArcs, outArcs;
+    compiledTables(net, inArcs, outArcs);
+    return computeTInvariants(net.numPlaces(), inArcs, outArcs, options);
+}
+
+vector<long long> invariantBounds(const CompiledNet& net, const vector<Invariant>& pInvariants) {
+    vector<long long> bound(net.numPlaces(), -1);
+    for (const Invariant& inv : pInvariants) {
+        __int128 total = 0;
+        for (const auto& e : inv.entries) total += (__int128)e.second * net.initialMarking()[e.first];
+        for (const auto& e : inv.entries) {
+            __int128 b = total / e.second;
+            long long v = b > LLONG_MAX ? LLONG_MAX : (long long)b;
+            if (bound[e.first] < 0 || v < bound[e.first]) bound[e.first] = v;
+        }
+    }
+    return bound;
+}
+
+void printInvariants(const PetriNet& net, const InvariantResult& pInvariants, const InvariantResult& tInvariants) {
+    const size_t shown = 20; //mạng lớn có thể có rất nhiều invariant
+    cout << "\n================ STRUCTURAL ANALYSIS ================" << endl;
+    cout << "--- " << pInvariants.invariants.size() << " minimal P-invariants"
+         << (pInvariants.complete ? "" : " (incomplete)") << " ---" << endl;
+    for (size_t i = 0; i < pInvariants.invariants.size() && i < shown; i++) {
+        long long total = 0;
+        cout << " ";
+        for (const auto& e : pInvariants.invariants[i].entries) {
+            cout << " " << e.second << "*" << net.places[e.first].id;
+            total += e.second * net.places[e.first].initialMarking;
+        }
+        cout << " = " << total << endl;
+    }
+    if (pInvariants.invariants.size() > shown) cout << "  ..." << endl;
+
+    cout << "--- " << tInvariants.invariants.size() << " minimal T-invariants"
+         << (tInvariants.complete ? "" : " (incomplete)") << " ---" << endl;
+    for (size_t i = 0; i < tInvariants.invariants.size() && i < shown; i++) {
+        cout << " ";
+        for (const auto& e : tInvariants.invariants[i].entries) cout << " " << e.second << "*" << net.transitions[e.first].id;
+        cout << endl;
+    }
+    if (tInvariants.invariants.size() > shown) cout << "  ..." << endl;
+    cout << "=====================================================" << endl;
+}
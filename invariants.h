@@ -0,0 +1,55 @@
+#ifndef INVARIANTS_H
+#define INVARIANTS_H
+
+#include "petriNet.h"
+#include "compiledNet.h"
+#include <cstddef>
+
+//một invariant bán dương: các cặp (chỉ số place/transition, hệ số > 0), tăng dần theo chỉ số
+struct Invariant {
+    vector<pair<int, long long>> entries;
+};
+
+struct InvariantResult {
+    vector<Invariant> invariants;
+    //false: có tổ hợp bị bỏ vì tràn số 64-bit hoặc vượt maxRows => có thể thiếu invariant
+    //(các invariant trả về vẫn đúng)
+    bool complete = true;
+};
+
+struct InvariantOptions {
+    //giới hạn số dòng trung gian của bảng Farkas; vượt quá thì dừng, trả về rỗng và complete = false
+    size_t maxRows = 200000;
+};
+
+/*
+ * Tính các invariant bán dương có support tối tiểu bằng thuật toán Farkas (Fourier–Motzkin):
+ *  - P-invariant: y >= 0, y != 0, yᵀ·C = 0   (C[p][t] = post - pre), Σ y_p·M(p) không đổi khi fire
+ *  - T-invariant: x >= 0, x != 0, C·x = 0     (fire đủ x_t lần mỗi transition thì quay về marking cũ)
+ *
+ * Bảng gồm các dòng thưa [phần tổ hợp | phần dư]; mỗi bước khử một cột của phần dư (chọn cột sinh ít
+ * dòng mới nhất), kết hợp dương từng cặp dòng trái dấu rồi chia gcd. Dòng có support (phần tổ hợp)
+ * chứa support của dòng khác bị loại ngay (support-minimality), support so bằng bitset.
+ * Phép nhân/cộng hệ số kiểm tra tràn; tổ hợp tràn bị bỏ qua và đánh dấu complete = false.
+ */
+InvariantResult computePInvariants(const CompiledNet& net, const InvariantOptions& options = InvariantOptions());
+InvariantResult computeTInvariants(const CompiledNet& net, const InvariantOptions& options = InvariantOptions());
+
+//cùng kết quả, từ bảng incidence inArcs/outArcs của buildTables()
+InvariantResult computePInvariants(int numPlaces, const vector<vector<pair<int,int>>>& inArcs,
+                                   const vector<vector<pair<int,int>>>& outArcs,
+                                   const InvariantOptions& options = InvariantOptions());
+InvariantResult computeTInvariants(int numPlaces, const vector<vector<pair<int,int>>>& inArcs,
+                                   const vector<vector<pair<int,int>>>& outArcs,
+                                   const InvariantOptions& options = InvariantOptions());
+
+/*
+ * Chặn trên số token của mỗi place suy ra từ P-invariant: với y chứa p,
+ * y_p·M(p) <= Σ y_q·M(q) = Σ y_q·M0(q)  =>  M(p) <= floor(y·M0 / y_p). Lấy min trên mọi y.
+ * -1: không P-invariant nào chứa p (không kết luận được bị chặn).
+ */
+vector<long long> invariantBounds(const CompiledNet& net, const vector<Invariant>& pInvariants);
+
+void printInvariants(const PetriNet& net, const InvariantResult& pInvariants, const InvariantResult& tInvariants);
+
+#endif
@@ -1,67 +1,105 @@
-#include "petriNet.h"
-#include "symbolicPetriNet.h"
-#include "deadlockDetector.h"
-
-#include <chrono>
-#include <iomanip>
-
-long long estimateExplicitMemory(const vector<Marking>& visited, int numPlaces) {
-    long long size = sizeof(visited); 
-    long long markingSize = sizeof(Marking) + (numPlaces * sizeof(int));
-    size += visited.size() * markingSize;
-    return size;
-}
-
-int main() {
-    try {
-        // Task 1: Parser
-        PetriNet net = loadPNML("simple_example.pnml");
-        verify(net);
-        printPetriNetInfo(net);
-
-        
-        // Task 2: BFS to enumerate all reachable markings from init
-        vector<Marking> R = BFS(net);
-        auto start1 = std::chrono::high_resolution_clock::now();
-        cout << "\nReachable markings:\n";
-        for (int i = 0; i < (int)R.size(); i++) {
-            cout << i << ": ";
-            printMarking(R[i]);
-            cout << "\n";
-        }
-
-        auto end1 = std::chrono::high_resolution_clock::now();
-        auto duration1 = std::chrono::duration_cast<std::chrono::microseconds>(end1 - start1);
-        long long mem1 = estimateExplicitMemory(R, net.places.size());
-        // Task 3: Symbolic computation
-        SymbolicPetriNet symNet(net);
-        auto start2 = std::chrono::high_resolution_clock::now();
-
-        symNet.initialize();
-        symNet.encodeInitialMarking();
-        symNet.buildTransitionRelations();
-        symNet.computeReachability();
-        symNet.printResults();
-
-        auto end2 = std::chrono::high_resolution_clock::now();
-        auto duration2 = std::chrono::duration_cast<std::chrono::microseconds>(end2 - start2);
-        long long mem2 = symNet.getBDDMemory();
-        //Compare Performance
-        std::cout << "==============PERFORMANCE COMPARISION==============" << std::endl;
-        std::cout << left << setw(15) << "Method" << setw(25) << "Time(microseconds)" << setw(15) << "Memory(bytes)" << std::endl; 
-        std::cout << left << setw(15) << "Explicit" << setw(25) << duration1.count() << setw(15) << mem1 << std::endl; 
-        std::cout << left << setw(15) << "Symbolic" << setw(25) << duration2.count() << setw(15) << mem2 << std::endl;
-
-
-        // Task 4: Deadlock detection
-        DeadlockDetector detector(net, symNet);
-        detector.detectDeadlock();
-        detector.printResults();
-        
-    } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        return 1;
-    }
-    
-    return 0;
+#include "petriNet.h"
+#include "symbolicPetriNet.h"
+#include "deadlockDetector.h"
+#include "invariants.h"
+#include "netReduction.h"
+#include "pnmlStream.h"
+#include "netCache.h"
+#include "parallelExplorer.h"
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+
+long long estimateExplicitMemory(const vector<Marking>& visited, int numPlaces) {
+    long long size = sizeof(visited); 
+    long long markingSize = sizeof(Marking) + (numPlaces * sizeof(int));
+    size += visited.size() * markingSize;
+    return size;
+}
+
+int main(int argc, char* argv[]) {
+    // --threads=N: số thread cho BFS tường minh (1 = BFS() tuần tự, 0 = số core)
+    int explicitThreads = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--threads=", 10) == 0) explicitThreads = atoi(argv[i] + 10);
+    }
+
+    try {
+        // Task 1: Parser
+        // parse + verify chỉ khi PNML đổi; lần sau mmap thẳng bản đã biên dịch trong cache
+        NetCache cached = loadNetCached("simple_example.pnml", "bdd_cache/simple_example.net");
+        PetriNet net = cached.toPetriNet();
+        printPetriNetInfo(net);
+
+        // Structural analysis: minimal P-/T-invariants of the incidence matrix
+        const CompiledNet& compiled = cached.compiled();
+        printInvariants(net, computePInvariants(compiled), computeTInvariants(compiled));
+
+        
+        // Task 2: BFS to enumerate all reachable markings from init
+        vector<Marking> R = explicitThreads == 1 ? BFS(compiled) : parallelBFS(compiled, explicitThreads);
+        auto start1 = std::chrono::high_resolution_clock::now();
+        cout << "\nReachable markings:\n";
+        for (int i = 0; i < (int)R.size(); i++) {
+            cout << i << ": ";
+            printMarking(R[i]);
+            cout << "\n";
+        }
+
+        auto end1 = std::chrono::high_resolution_clock::now();
+        auto duration1 = std::chrono::duration_cast<std::chrono::microseconds>(end1 - start1);
+        long long mem1 = estimateExplicitMemory(R, net.places.size());
+        // Task 3: Symbolic computation
+        SymbolicOptions symOptions;
+        symOptions.cacheDirectory = "bdd_cache"; // reachable set reused across runs on the same net
+        SymbolicPetriNet symNet(net, symOptions);
+        auto start2 = std::chrono::high_resolution_clock::now();
+
+        symNet.initialize();
+        symNet.encodeInitialMarking();
+        if (!symNet.loadReachableStates()) {
+            symNet.buildTransitionRelations();
+            symNet.computeReachability();
+            symNet.storeReachableStates();
+        }
+        symNet.printResults();
+
+        auto end2 = std::chrono::high_resolution_clock::now();
+        auto duration2 = std::chrono::duration_cast<std::chrono::microseconds>(end2 - start2);
+        long long mem2 = symNet.getBDDMemory();
+        //Compare Performance
+        std::cout << "==============PERFORMANCE COMPARISION==============" << std::endl;
+        std::cout << left << setw(15) << "Method" << setw(25) << "Time(microseconds)" << setw(15) << "Memory(bytes)" << std::endl; 
+        std::cout << left << setw(15) << "Explicit" << setw(25) << duration1.count() << setw(15) << mem1 << std::endl; 
+        std::cout << left << setw(15) << "Symbolic" << setw(25) << duration2.count() << setw(15) << mem2 << std::endl;
+
+
+        // Task 4: Deadlock detection trên mạng đã rút gọn cấu trúc (giữ nguyên câu hỏi có deadlock không)
+        ReducedNet reduced = reduceNet(net);
+        printReductionInfo(net, reduced);
+        SymbolicPetriNet reducedSymNet(reduced.net, symOptions);
+        reducedSymNet.initialize();
+        reducedSymNet.encodeInitialMarking();
+        if (!reducedSymNet.loadReachableStates()) {
+            reducedSymNet.buildTransitionRelations();
+            reducedSymNet.computeReachability();
+            reducedSymNet.storeReachableStates();
+        }
+        DeadlockDetector detector(reduced.net, reducedSymNet);
+        if (detector.detectDeadlock()) {
+            // witness theo place của mạng gốc
+            Marking original = reduced.expand(detector.getDeadlockMarking());
+            std::cout << "Deadlock marking (original places): ";
+            printMarking(original);
+            std::cout << std::endl;
+        }
+        detector.printResults();
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
 }
\ No newline at end of file
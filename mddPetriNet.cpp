@@ -0,0 +1,374 @@
+#include "mddPetriNet.h"
+#include "stateStore.h"
+#include <iostream>
+#include <stdexcept>
+
+MddPetriNet::MddPetriNet(const PetriNet& petriNet, const MddOptions& options)
+    : net(petriNet), compiled(petriNet), options(options),
+      uniqueMask(0), cacheMask(0), cacheHits(0), cacheLookups(0),
+      initialState(0), reachableStates(0) {
+    numPlaces = compiled.numPlaces();
+    numTransitions = compiled.numTransitions();
+}
+
+void MddPetriNet::initialize() {
+    if (options.tokenBound < 0) {
+        throw std::runtime_error("MddOptions::tokenBound must be >= 0");
+    }
+
+    // placeOrder[0] sits on the top level
+    placeOrder = computePlaceOrder(compiled, options.order);
+    levelPlace.assign(numPlaces + 1, -1);
+    placeLevel.assign(numPlaces, 0);
+    for (int k = 0; k < numPlaces; k++) {
+        levelPlace[numPlaces - k] = placeOrder[k];
+        placeLevel[placeOrder[k]] = numPlaces - k;
+    }
+
+    // terminals: 0 = empty set, 1 = {()}
+    nodes.assign({{0, 0, 0}, {0, 0, 0}});
+    childPool.clear();
+    uniqueTable.assign(1024, -1);
+    uniqueMask = uniqueTable.size() - 1;
+
+    size_t cacheSlots = 1024;
+    while (cacheSlots < options.cacheSize) cacheSlots <<= 1;
+    cache.assign(cacheSlots, {0, 0, 0, 0});
+    cacheMask = cacheSlots - 1;
+    cacheHits = cacheLookups = 0;
+
+    std::cout << "\n[MDD] Initialized MDD with " << numPlaces << " levels ("
+              << variableOrderName(options.order) << " place order, "
+              << (options.tokenBound ? "bound " + std::to_string(options.tokenBound) : std::string("unbounded domains"))
+              << ", cache " << cacheSlots << " entries)" << std::endl;
+}
+
+void MddPetriNet::encodeInitialMarking() {
+    const vector<int>& m0 = compiled.initialMarking();
+    int node = 1;
+    vector<int> children;
+    for (int level = 1; level <= numPlaces; level++) {
+        int v = m0[levelPlace[level]];
+        if (options.tokenBound && v > options.tokenBound) {
+            throw std::runtime_error("Initial marking of place " + net.places[levelPlace[level]].id + " exceeds the token bound");
+        }
+        children.assign(v + 1, 0);
+        children[v] = node;
+        node = makeNode(level, children);
+    }
+    initialState = node;
+
+    std::cout << "[MDD] Encoded initial marking" << std::endl;
+}
+
+void MddPetriNet::buildTransitionRelations() {
+    effects.assign(numTransitions, {});
+    eventsByTop.assign(numPlaces + 1, {});
+
+    vector<int> consumed(numPlaces, 0), produced(numPlaces, 0);
+    for (int t = 0; t < numTransitions; t++) {
+        vector<int> touched;
+        for (const IncidenceEntry* e = compiled.preBegin(t); e != compiled.preEnd(t); ++e) {
+            if (!consumed[e->place] && !produced[e->place]) touched.push_back(e->place);
+            consumed[e->place] += e->weight;
+        }
+        for (const IncidenceEntry* e = compiled.postBegin(t); e != compiled.postEnd(t); ++e) {
+            if (!consumed[e->place] && !produced[e->place]) touched.push_back(e->place);
+            produced[e->place] += e->weight;
+        }
+        for (int p : touched) {
+            effects[t].push_back({placeLevel[p], consumed[p], produced[p]});
+            consumed[p] = produced[p] = 0;
+        }
+        sort(effects[t].begin(), effects[t].end(),
+             [](const LevelEffect& a, const LevelEffect& b) { return a.level > b.level; });
+        // a transition without arcs never changes the marking
+        if (!effects[t].empty()) eventsByTop[effects[t][0].level].push_back(t);
+    }
+
+    std::cout << "[MDD] Built local effects for " << numTransitions << " transitions" << std::endl;
+}
+
+void MddPetriNet::computeReachability() {
+    std::cout << "[MDD] Computing reachability (frontier)..." << std::endl;
+
+    reachableStates = initialState;
+    int frontier = initialState;
+    int iteration = 0;
+    while (frontier != 0) {
+        iteration++;
+        int img = imageComputation(frontier);
+        frontier = differenceOf(img, reachableStates);
+        reachableStates = unionOf(reachableStates, frontier);
+    }
+
+    std::cout << "[MDD] Fixed point reached at iteration " << iteration << std::endl;
+}
+
+void MddPetriNet::computeReachabilitySaturation() {
+    std::cout << "[MDD] Computing reachability (saturation)..." << std::endl;
+    reachableStates = saturate(initialState);
+    std::cout << "[MDD] Saturation done" << std::endl;
+}
+
+/*
+ * Check whether a marking (real token counts, indexed like net.places) is reachable:
+ * follow the edge labelled with the token count of each level's place.
+ */
+bool MddPetriNet::contains(const vector<int>& marking) {
+    if (marking.size() != net.places.size()) return false;
+    int node = reachableStates;
+    for (int level = numPlaces; level >= 1 && node != 0; level--) {
+        int v = marking[levelPlace[level]];
+        if (v < 0) return false;
+        node = child(node, v);
+    }
+    return node == 1;
+}
+
+// nodes are created after their children, so one pass in id order counts every node
+double MddPetriNet::countStates() {
+    vector<double> count(nodes.size(), 0.0);
+    count[1] = 1.0;
+    for (size_t n = 2; n < nodes.size(); n++) {
+        for (int i = 0; i < nodes[n].size; i++) count[n] += count[childPool[nodes[n].offset + i]];
+    }
+    return count[reachableStates];
+}
+
+long long MddPetriNet::getMDDMemory() const {
+    return (long long)(nodes.capacity() * sizeof(Node) + childPool.capacity() * sizeof(int)
+                       + uniqueTable.capacity() * sizeof(int) + cache.capacity() * sizeof(CacheEntry));
+}
+
+void MddPetriNet::printResults() {
+    // nodes of the reachable set: everything reachable from its root
+    vector<bool> seen(nodes.size(), false);
+    vector<int> stack{reachableStates};
+    long long reachableNodes = 0;
+    while (!stack.empty()) {
+        int n = stack.back();
+        stack.pop_back();
+        if (n <= 1 || seen[n]) continue;
+        seen[n] = true;
+        reachableNodes++;
+        for (int i = 0; i < nodes[n].size; i++) stack.push_back(childPool[nodes[n].offset + i]);
+    }
+    int widestDomain = 0;
+    for (size_t n = 2; n < nodes.size(); n++) widestDomain = max(widestDomain, nodes[n].size);
+
+    std::cout << "\n========== MDD REACHABILITY ==========" << std::endl;
+    std::cout << "Number of places: " << numPlaces << std::endl;
+    std::cout << "Number of transitions: " << numTransitions << std::endl;
+    std::cout << "Number of reachable states: " << countStates() << std::endl;
+    std::cout << "MDD nodes (reachable set): " << reachableNodes << std::endl;
+    std::cout << "MDD nodes (store): " << nodes.size() << ", largest domain used: " << widestDomain << std::endl;
+    std::cout << "Operation cache hit rate: "
+              << (cacheLookups ? 100.0 * cacheHits / cacheLookups : 0.0) << "% of " << cacheLookups << " lookups" << std::endl;
+    std::cout << "======================================" << std::endl;
+}
+
+/*
+ * Hash-consing: return the unique node (level, children). Trailing empty children are
+ * trimmed so equal sets always get the same node; an all-empty node is the empty set 0.
+ */
+int MddPetriNet::makeNode(int level, vector<int>& children) {
+    while (!children.empty() && children.back() == 0) children.pop_back();
+    if (children.empty()) return 0;
+
+    int size = (int)children.size();
+    uint64_t h = hashState(children.data(), size) ^ ((uint64_t)level * 0x9E3779B97F4A7C15ULL);
+    size_t pos = h & uniqueMask;
+    while (uniqueTable[pos] != -1) {
+        const Node& n = nodes[uniqueTable[pos]];
+        if (n.level == level && n.size == size
+            && equal(children.begin(), children.end(), childPool.begin() + n.offset)) {
+            return uniqueTable[pos];
+        }
+        pos = (pos + 1) & uniqueMask;
+    }
+
+    int id = (int)nodes.size();
+    nodes.push_back({level, (int)childPool.size(), size});
+    childPool.insert(childPool.end(), children.begin(), children.end());
+    uniqueTable[pos] = id;
+    //keep load factor <= 0.5
+    if (nodes.size() * 2 > uniqueTable.size()) growUniqueTable();
+    return id;
+}
+
+void MddPetriNet::growUniqueTable() {
+    uniqueTable.assign(uniqueTable.size() * 2, -1);
+    uniqueMask = uniqueTable.size() - 1;
+    for (size_t id = 2; id < nodes.size(); id++) {
+        const Node& n = nodes[id];
+        uint64_t h = hashState(childPool.data() + n.offset, n.size) ^ ((uint64_t)n.level * 0x9E3779B97F4A7C15ULL);
+        size_t pos = h & uniqueMask;
+        while (uniqueTable[pos] != -1) pos = (pos + 1) & uniqueMask;
+        uniqueTable[pos] = (int)id;
+    }
+}
+
+static size_t cacheSlot(int op, int a, int b) {
+    int key[3] = {op, a, b};
+    return (size_t)hashState(key, 3);
+}
+
+bool MddPetriNet::cacheFind(int op, int a, int b, int& result) {
+    cacheLookups++;
+    const CacheEntry& e = cache[cacheSlot(op, a, b) & cacheMask];
+    if (e.op == op && e.a == a && e.b == b) {
+        cacheHits++;
+        result = e.result;
+        return true;
+    }
+    return false;
+}
+
+void MddPetriNet::cacheInsert(int op, int a, int b, int result) {
+    cache[cacheSlot(op, a, b) & cacheMask] = {op, a, b, result};
+}
+
+int MddPetriNet::unionOf(int a, int b) {
+    if (a == 0 || a == b) return b;
+    if (b == 0) return a;
+    if (a > b) swap(a, b); //commutative: one cache entry for both orders
+    int result;
+    if (cacheFind(OpUnion, a, b, result)) return result;
+
+    int size = max(nodes[a].size, nodes[b].size);
+    vector<int> children(size);
+    for (int i = 0; i < size; i++) children[i] = unionOf(child(a, i), child(b, i));
+    result = makeNode(nodes[a].level, children);
+    cacheInsert(OpUnion, a, b, result);
+    return result;
+}
+
+int MddPetriNet::differenceOf(int a, int b) {
+    if (a == 0 || a == b) return 0;
+    if (b == 0) return a;
+    int result;
+    if (cacheFind(OpDifference, a, b, result)) return result;
+
+    vector<int> children(nodes[a].size);
+    for (int i = 0; i < nodes[a].size; i++) children[i] = differenceOf(child(a, i), child(b, i));
+    result = makeNode(nodes[a].level, children);
+    cacheInsert(OpDifference, a, b, result);
+    return result;
+}
+
+/*
+ * One-step image of node under transition t. effect points at the first touched level at
+ * or below the node's level; untouched levels keep their value, and once every touched
+ * level has been handled the rest of the node is returned as is.
+ */
+int MddPetriNet::imageOf(int t, const LevelEffect* effect, int node) {
+    if (node == 0 || effect == effects[t].data() + effects[t].size()) return node;
+    int result;
+    if (cacheFind(OpImage, t, node, result)) return result;
+
+    int level = nodes[node].level;
+    vector<int> children;
+    for (int i = 0; i < nodes[node].size; i++) {
+        int c = child(node, i);
+        if (c == 0) continue;
+        if (effect->level != level) {
+            if ((int)children.size() <= i) children.resize(i + 1, 0);
+            children[i] = imageOf(t, effect, c);
+            continue;
+        }
+        if (i < effect->consumed) continue;
+        int j = i - effect->consumed + effect->produced;
+        if (options.tokenBound && j > options.tokenBound) continue;
+        int f = imageOf(t, effect + 1, c);
+        if (f == 0) continue;
+        if ((int)children.size() <= j) children.resize(j + 1, 0);
+        children[j] = unionOf(children[j], f);
+    }
+    result = makeNode(level, children);
+    cacheInsert(OpImage, t, node, result);
+    return result;
+}
+
+int MddPetriNet::imageComputation(int states) {
+    int result = 0;
+    for (int t = 0; t < numTransitions; t++) {
+        result = unionOf(result, imageOf(t, effects[t].data(), states));
+    }
+    return result;
+}
+
+/*
+ * Like imageOf, but for the levels below top(t) inside saturation: the result is
+ * saturated before it is returned, so it is closed under every transition whose
+ * top level is at or below the node's level.
+ */
+int MddPetriNet::fire(int t, const LevelEffect* effect, int node) {
+    if (node == 0 || effect == effects[t].data() + effects[t].size()) return node;
+    int result;
+    if (cacheFind(OpFire, t, node, result)) return result;
+
+    int level = nodes[node].level;
+    vector<int> children;
+    for (int i = 0; i < nodes[node].size; i++) {
+        int c = child(node, i);
+        if (c == 0) continue;
+        if (effect->level != level) {
+            if ((int)children.size() <= i) children.resize(i + 1, 0);
+            children[i] = unionOf(children[i], fire(t, effect, c));
+            continue;
+        }
+        if (i < effect->consumed) continue;
+        int j = i - effect->consumed + effect->produced;
+        if (options.tokenBound && j > options.tokenBound) continue;
+        int f = fire(t, effect + 1, c);
+        if (f == 0) continue;
+        if ((int)children.size() <= j) children.resize(j + 1, 0);
+        children[j] = unionOf(children[j], f);
+    }
+    result = saturate(makeNode(level, children));
+    cacheInsert(OpFire, t, node, result);
+    return result;
+}
+
+/*
+ * Saturation: saturate the children first (closing them under every transition that
+ * lives entirely below this level), then fire the transitions whose top is this level
+ * until nothing new appears. Unions of saturated nodes stay saturated, so the children
+ * never need to be revisited.
+ */
+int MddPetriNet::saturate(int node) {
+    if (node <= 1) return node;
+    int result;
+    if (cacheFind(OpSaturate, node, 0, result)) return result;
+
+    int level = nodes[node].level;
+    vector<int> children(nodes[node].size);
+    for (int i = 0; i < (int)children.size(); i++) children[i] = saturate(child(node, i));
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int t : eventsByTop[level]) {
+            const LevelEffect* effect = effects[t].data();
+            // children may grow while firing: new values are visited in the same sweep
+            for (int i = effect->consumed; i < (int)children.size(); i++) {
+                if (children[i] == 0) continue;
+                int j = i - effect->consumed + effect->produced;
+                if (options.tokenBound && j > options.tokenBound) continue;
+                int f = fire(t, effect + 1, children[i]);
+                if (f == 0) continue;
+                if ((int)children.size() <= j) children.resize(j + 1, 0);
+                int u = unionOf(children[j], f);
+                if (u != children[j]) {
+                    children[j] = u;
+                    changed = true;
+                }
+            }
+        }
+    }
+    result = makeNode(level, children);
+    cacheInsert(OpSaturate, node, 0, result);
+    cacheInsert(OpSaturate, result, 0, result);
+    return result;
+}
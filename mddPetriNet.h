@@ -0,0 +1,111 @@
+#ifndef MDD_PETRI_NET_H
+#define MDD_PETRI_NET_H
+
+#include "petriNet.h"
+#include "compiledNet.h"
+#include "variableOrder.h"
+#include <cstdint>
+
+//configuration chosen at construction time
+struct MddOptions {
+    //place order on the MDD levels; placeOrder[0] is the top level
+    VariableOrder order = VariableOrder::Force;
+    //largest token count kept per place. 0: no bound, domains grow as markings are found
+    //(the net must then be bounded, otherwise reachability does not terminate).
+    //With a bound, firings that would exceed it are not represented.
+    int tokenBound = 0;
+    //entries of the operation cache (rounded up to a power of two); lossy, direct-mapped
+    size_t cacheSize = 1 << 20;
+};
+
+/*
+ * Reachability with multi-valued decision diagrams: one MDD level per place, the value of
+ * a level is the token count of its place, so k tokens cost one edge instead of a
+ * ceil(log2(k+1))-bit counter.
+ *
+ * - Nodes are quasi-reduced (every path visits every level) and hash-consed in a unique
+ *   table; children of a node are stored contiguously, trailing empty children trimmed,
+ *   so a domain grows with the largest value actually seen.
+ * - Transitions are applied implicitly, level by level, from their pre/post incidence
+ *   (no relation diagram): levels outside [bottom(t), top(t)] are left untouched.
+ * - union, image and saturation results are memoised in a direct-mapped operation cache.
+ * - Nodes are never freed; the store lives as long as the MddPetriNet.
+ *
+ * Usage mirrors SymbolicPetriNet: initialize(), encodeInitialMarking(),
+ * buildTransitionRelations(), then computeReachability() or computeReachabilitySaturation().
+ */
+class MddPetriNet {
+public:
+    MddPetriNet(const PetriNet& petriNet, const MddOptions& options = MddOptions());
+    void initialize();
+    void encodeInitialMarking();
+    void buildTransitionRelations();
+    void computeReachability();           //frontier iteration with image + union
+    void computeReachabilitySaturation(); //saturation (Ciardo, Lüttgen, Siminiceanu 2001)
+    bool contains(const vector<int>& marking);
+    double countStates();
+    void printResults();
+    const CompiledNet& getCompiledNet() const { return compiled; }
+    int getNodeCount() const { return (int)nodes.size(); }
+    long long getMDDMemory() const;
+private:
+    //node 0: empty set, node 1: terminal {()} at level 0
+    struct Node {
+        int level;  //1..numPlaces, 0 for the terminals
+        int offset; //children in childPool[offset .. offset+size)
+        int size;
+    };
+    struct CacheEntry {
+        int op;
+        int a;
+        int b;
+        int result;
+    };
+    //effect of a transition on the place of one level
+    struct LevelEffect {
+        int level;
+        int consumed;
+        int produced;
+    };
+    enum Operation { OpUnion = 1, OpDifference, OpImage, OpFire, OpSaturate };
+
+    PetriNet net;
+    CompiledNet compiled;
+    MddOptions options;
+    int numPlaces;
+    int numTransitions;
+    vector<int> placeOrder; //placeOrder[k] = place at level numPlaces - k
+    vector<int> levelPlace; //levelPlace[level] = place, level 1..numPlaces
+    vector<int> placeLevel;
+
+    vector<Node> nodes;
+    vector<int> childPool;
+    vector<int> uniqueTable; //node ids, -1 = empty slot
+    size_t uniqueMask;
+    vector<CacheEntry> cache;
+    size_t cacheMask;
+    long long cacheHits;
+    long long cacheLookups;
+
+    vector<vector<LevelEffect>> effects; //per transition, top level first
+    vector<vector<int>> eventsByTop;     //transitions whose highest touched level is k
+    int initialState;
+    int reachableStates;
+private:
+    int child(int node, int value) const {
+        const Node& n = nodes[node];
+        return value < n.size ? childPool[n.offset + value] : 0;
+    }
+    int makeNode(int level, vector<int>& children);
+    void growUniqueTable();
+    bool cacheFind(int op, int a, int b, int& result);
+    void cacheInsert(int op, int a, int b, int result);
+    int unionOf(int a, int b);
+    int differenceOf(int a, int b);
+    int imageOf(int t, const LevelEffect* effect, int node);
+    int imageComputation(int states);
+    int fire(int t, const LevelEffect* effect, int node);
+    int saturate(int node);
+};
+
+#endif
@@ -0,0 +1,359 @@
+#include "netCache.h"
+#include "pnmlStream.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char CACHE_MAGIC[8] = {'P', 'N', 'C', 'A', 'C', 'H', 'E', '\0'};
+const uint32_t CACHE_VERSION = 1;
+const uint32_t ENDIAN_TAG = 0x01020304;
+
+enum Section {
+    PRE_OFFSETS, PRE_ENTRIES, POST_OFFSETS, POST_ENTRIES,
+    CONSUMER_OFFSETS, CONSUMER_LIST, PRODUCER_OFFSETS, PRODUCER_LIST,
+    AFFECTED_OFFSETS, AFFECTED_LIST,
+    INITIAL_MARKING, ARCS,
+    PLACE_ID, PLACE_NAME, TRANSITION_ID, TRANSITION_NAME, //offset vào STRINGS
+    PLACE_LOOKUP, TRANSITION_LOOKUP,                      //bảng băm id -> chỉ số + 1 (0 = slot trống)
+    STRINGS,
+    NUM_SECTIONS
+};
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t endianTag;
+    uint64_t sourceHash;
+    uint64_t fileSize;
+    int32_t numPlaces, numTransitions, numArcs, reserved;
+    uint64_t offset[NUM_SECTIONS]; //vị trí section, tính từ đầu file (căn 8 byte)
+    uint64_t bytes[NUM_SECTIONS];
+};
+
+//cung gốc; source/target là offset chuỗi (trùng offset id của place/transition khi resolve được)
+struct CachedArc {
+    uint32_t source;
+    uint32_t target;
+    int32_t weight;
+    uint32_t id;
+};
+
+static_assert(sizeof(IncidenceEntry) == 2 * sizeof(int32_t), "IncidenceEntry must be two packed ints");
+static_assert(sizeof(int) == sizeof(int32_t), "cache layout assumes 32-bit int");
+
+//FNV-1a + finalizer như hashState; bit thấp dùng làm chỉ số slot
+uint64_t hashId(const char* s, size_t n) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < n; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 0x100000001B3ULL;
+    }
+    h ^= h >> 30; h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27; h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+size_t lookupSlots(size_t n) {
+    size_t slots = 2;
+    while (slots < 2 * n) slots <<= 1;
+    return slots;
+}
+
+//bảng băm open-addressing id -> chỉ số + 1; id trùng: giữ phần tử đầu tiên
+template <class Element>
+vector<uint32_t> buildLookup(const vector<Element>& elements, const vector<uint32_t>& idOffsets, const string& blob) {
+    vector<uint32_t> slots(lookupSlots(elements.size()), 0);
+    size_t mask = slots.size() - 1;
+    for (size_t i = 0; i < elements.size(); i++) {
+        const string& id = elements[i].id;
+        size_t pos = hashId(id.data(), id.size()) & mask;
+        while (slots[pos] != 0 && strcmp(blob.c_str() + idOffsets[slots[pos] - 1], id.c_str()) != 0)
+            pos = (pos + 1) & mask;
+        if (slots[pos] == 0) slots[pos] = i + 1;
+    }
+    return slots;
+}
+
+int probeLookup(const uint32_t* slots, size_t numSlots, const uint32_t* idOffsets, const char* strings, const string& id) {
+    size_t mask = numSlots - 1;
+    size_t pos = hashId(id.data(), id.size()) & mask;
+    while (slots[pos] != 0) {
+        if (strcmp(strings + idOffsets[slots[pos] - 1], id.c_str()) == 0) return slots[pos] - 1;
+        pos = (pos + 1) & mask;
+    }
+    return -1;
+}
+
+//ghi tuần tự các section, header ghi sau cùng khi đã biết mọi offset
+class CacheWriter {
+public:
+    explicit CacheWriter(FILE* out) : out(out) {
+        memset(&header, 0, sizeof(header));
+        pos = sizeof(header);
+        if (fseek(out, pos, SEEK_SET) != 0) throw runtime_error("Cannot write net cache");
+    }
+
+    void section(Section s, const void* data, size_t bytes) {
+        static const char zeros[8] = {};
+        size_t pad = (8 - pos % 8) % 8;
+        if (pad && fwrite(zeros, 1, pad, out) != pad) throw runtime_error("Cannot write net cache");
+        pos += pad;
+        header.offset[s] = pos;
+        header.bytes[s] = bytes;
+        if (bytes && fwrite(data, 1, bytes, out) != bytes) throw runtime_error("Cannot write net cache");
+        pos += bytes;
+    }
+    template <class T>
+    void section(Section s, const T* data, size_t count) { section(s, (const void*)data, count * sizeof(T)); }
+    template <class T>
+    void section(Section s, const vector<T>& v) { section(s, v.data(), v.size()); }
+
+    void finish() {
+        header.fileSize = pos;
+        if (fseek(out, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, out) != 1)
+            throw runtime_error("Cannot write net cache");
+    }
+
+    CacheHeader header;
+
+private:
+    FILE* out;
+    size_t pos;
+};
+
+}
+
+//vùng map của 1 file cache; munmap khi bản CompiledNet/NetCache cuối cùng dùng nó bị hủy
+struct MappedCacheFile {
+    const char* base = nullptr;
+    size_t size = 0;
+
+    ~MappedCacheFile() {
+        if (base) munmap((void*)base, size);
+    }
+    const CacheHeader& header() const { return *(const CacheHeader*)base; }
+    template <class T>
+    const T* at(Section s) const { return (const T*)(base + header().offset[s]); }
+    size_t count(Section s, size_t elementSize) const { return header().bytes[s] / elementSize; }
+};
+
+uint64_t hashFileContents(const string& filename) {
+    unique_ptr<FILE, int (*)(FILE*)> file(fopen(filename.c_str(), "rb"), fclose);
+    if (!file) throw runtime_error("Cannot open file: " + filename);
+
+    //trộn từng word 8 byte như hashState(); phần lẻ cuối file đệm 0, độ dài trộn vào finalizer
+    vector<uint64_t> buffer(1 << 13);
+    uint64_t h = 0x9E3779B97F4A7C15ULL, total = 0;
+    size_t got;
+    while ((got = fread(buffer.data(), 1, buffer.size() * sizeof(uint64_t), file.get())) > 0) {
+        if (got % sizeof(uint64_t)) memset((char*)buffer.data() + got, 0, sizeof(uint64_t) - got % sizeof(uint64_t));
+        size_t words = (got + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+        for (size_t i = 0; i < words; i++) {
+            h ^= buffer[i];
+            h *= 0xFF51AFD7ED558CCDULL;
+            h ^= h >> 32;
+        }
+        total += got;
+    }
+    h ^= total;
+    h ^= h >> 30; h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27; h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+void writeNetCache(const string& cacheFile, const PetriNet& net, uint64_t sourceHash) {
+    CompiledNet compiled(net);
+    SymbolTable scratch;
+    const SymbolTable& symbols = symbolsOf(net, scratch);
+    const CompiledArrays& a = compiled.arrays();
+    int P = compiled.numPlaces(), T = compiled.numTransitions();
+
+    //bảng chuỗi: mỗi chuỗi kết thúc bằng '\0', dùng thẳng làm const char* sau khi map
+    string blob;
+    auto intern = [&blob](const string& s) {
+        uint32_t offset = blob.size();
+        blob.append(s).push_back('\0');
+        return offset;
+    };
+    vector<uint32_t> placeId(P), placeName(P), transitionId(T), transitionName(T);
+    for (int p = 0; p < P; p++) {
+        placeId[p] = intern(net.places[p].id);
+        placeName[p] = intern(net.places[p].name);
+    }
+    for (int t = 0; t < T; t++) {
+        transitionId[t] = intern(net.transitions[t].id);
+        transitionName[t] = intern(net.transitions[t].name);
+    }
+    auto endpoint = [&](const string& id) {
+        int p = symbols.place(id);
+        if (p != -1) return placeId[p];
+        int t = symbols.transition(id);
+        return t != -1 ? transitionId[t] : intern(id);
+    };
+    vector<CachedArc> arcs;
+    arcs.reserve(net.arcs.size());
+    for (const auto& arc : net.arcs)
+        arcs.push_back({endpoint(arc.source), endpoint(arc.target), arc.weight, intern(arc.id)});
+    if (blob.size() > UINT32_MAX) throw runtime_error("Net too large for cache: " + cacheFile);
+
+    std::filesystem::path path(cacheFile);
+    if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path());
+    string tmpFile = cacheFile + ".tmp" + to_string(getpid());
+    {
+        unique_ptr<FILE, int (*)(FILE*)> out(fopen(tmpFile.c_str(), "wb"), fclose);
+        if (!out) throw runtime_error("Cannot write net cache: " + cacheFile);
+        CacheWriter writer(out.get());
+        writer.section(PRE_OFFSETS, a.preOffsets, T + 1);
+        writer.section(PRE_ENTRIES, a.preEntries, a.preOffsets[T]);
+        writer.section(POST_OFFSETS, a.postOffsets, T + 1);
+        writer.section(POST_ENTRIES, a.postEntries, a.postOffsets[T]);
+        writer.section(CONSUMER_OFFSETS, a.consumerOffsets, P + 1);
+        writer.section(CONSUMER_LIST, a.consumerList, a.consumerOffsets[P]);
+        writer.section(PRODUCER_OFFSETS, a.producerOffsets, P + 1);
+        writer.section(PRODUCER_LIST, a.producerList, a.producerOffsets[P]);
+        writer.section(AFFECTED_OFFSETS, a.affectedOffsets, T + 1);
+        writer.section(AFFECTED_LIST, a.affectedList, a.affectedOffsets[T]);
+        writer.section(INITIAL_MARKING, compiled.initialMarking());
+        writer.section(ARCS, arcs);
+        writer.section(PLACE_ID, placeId);
+        writer.section(PLACE_NAME, placeName);
+        writer.section(TRANSITION_ID, transitionId);
+        writer.section(TRANSITION_NAME, transitionName);
+        writer.section(PLACE_LOOKUP, buildLookup(net.places, placeId, blob));
+        writer.section(TRANSITION_LOOKUP, buildLookup(net.transitions, transitionId, blob));
+        writer.section(STRINGS, blob.data(), blob.size());
+
+        CacheHeader& h = writer.header;
+        memcpy(h.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        h.version = CACHE_VERSION;
+        h.endianTag = ENDIAN_TAG;
+        h.sourceHash = sourceHash;
+        h.numPlaces = P;
+        h.numTransitions = T;
+        h.numArcs = arcs.size();
+        writer.finish();
+        if (fflush(out.get()) != 0) throw runtime_error("Cannot write net cache: " + cacheFile);
+    }
+    std::filesystem::rename(tmpFile, cacheFile);
+}
+
+bool NetCache::open(const string& cacheFile, uint64_t sourceHash) {
+    int fd = ::open(cacheFile.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    auto mapped = make_shared<MappedCacheFile>();
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(CacheHeader)) {
+        void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base != MAP_FAILED) {
+            mapped->base = (const char*)base;
+            mapped->size = st.st_size;
+        }
+    }
+    ::close(fd);
+    if (!mapped->base) return false;
+
+    //chỉ kiểm tra header và kích thước section (O(1)), nội dung section được tin như lúc ghi
+    const CacheHeader& h = mapped->header();
+    if (memcmp(h.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || h.version != CACHE_VERSION ||
+        h.endianTag != ENDIAN_TAG || h.sourceHash != sourceHash || h.fileSize != mapped->size ||
+        h.numPlaces < 0 || h.numTransitions < 0 || h.numArcs < 0)
+        return false;
+    for (int s = 0; s < NUM_SECTIONS; s++)
+        if (h.offset[s] % 8 != 0 || h.offset[s] > h.fileSize || h.bytes[s] > h.fileSize - h.offset[s]) return false;
+    size_t P = h.numPlaces, T = h.numTransitions;
+    auto fits = [&](Section s, size_t count, size_t elementSize) { return h.bytes[s] == count * elementSize; };
+    if (!fits(PRE_OFFSETS, T + 1, 4) || !fits(POST_OFFSETS, T + 1, 4) || !fits(AFFECTED_OFFSETS, T + 1, 4) ||
+        !fits(CONSUMER_OFFSETS, P + 1, 4) || !fits(PRODUCER_OFFSETS, P + 1, 4) || !fits(INITIAL_MARKING, P, 4) ||
+        !fits(PLACE_ID, P, 4) || !fits(PLACE_NAME, P, 4) || !fits(TRANSITION_ID, T, 4) ||
+        !fits(TRANSITION_NAME, T, 4) || !fits(ARCS, h.numArcs, sizeof(CachedArc)) ||
+        !fits(PLACE_LOOKUP, lookupSlots(P), 4) || !fits(TRANSITION_LOOKUP, lookupSlots(T), 4) ||
+        h.bytes[STRINGS] == 0 || mapped->base[h.offset[STRINGS] + h.bytes[STRINGS] - 1] != '\0')
+        return false;
+
+    CompiledArrays a = {
+        mapped->at<int>(PRE_OFFSETS), mapped->at<IncidenceEntry>(PRE_ENTRIES),
+        mapped->at<int>(POST_OFFSETS), mapped->at<IncidenceEntry>(POST_ENTRIES),
+        mapped->at<int>(CONSUMER_OFFSETS), mapped->at<int>(CONSUMER_LIST),
+        mapped->at<int>(PRODUCER_OFFSETS), mapped->at<int>(PRODUCER_LIST),
+        mapped->at<int>(AFFECTED_OFFSETS), mapped->at<int>(AFFECTED_LIST)};
+    if (!fits(PRE_ENTRIES, a.preOffsets[T], sizeof(IncidenceEntry)) ||
+        !fits(POST_ENTRIES, a.postOffsets[T], sizeof(IncidenceEntry)) ||
+        !fits(CONSUMER_LIST, a.consumerOffsets[P], 4) || !fits(PRODUCER_LIST, a.producerOffsets[P], 4) ||
+        !fits(AFFECTED_LIST, a.affectedOffsets[T], 4))
+        return false;
+
+    const int* m0 = mapped->at<int>(INITIAL_MARKING);
+    net = CompiledNet(P, T, vector<int>(m0, m0 + P), a, mapped);
+    arcCount = h.numArcs;
+    file = mapped;
+    return true;
+}
+
+const char* NetCache::placeId(int p) const {
+    return file->at<char>(STRINGS) + file->at<uint32_t>(PLACE_ID)[p];
+}
+const char* NetCache::placeName(int p) const {
+    return file->at<char>(STRINGS) + file->at<uint32_t>(PLACE_NAME)[p];
+}
+const char* NetCache::transitionId(int t) const {
+    return file->at<char>(STRINGS) + file->at<uint32_t>(TRANSITION_ID)[t];
+}
+const char* NetCache::transitionName(int t) const {
+    return file->at<char>(STRINGS) + file->at<uint32_t>(TRANSITION_NAME)[t];
+}
+
+int NetCache::findPlace(const string& id) const {
+    return probeLookup(file->at<uint32_t>(PLACE_LOOKUP), file->count(PLACE_LOOKUP, 4),
+                       file->at<uint32_t>(PLACE_ID), file->at<char>(STRINGS), id);
+}
+int NetCache::findTransition(const string& id) const {
+    return probeLookup(file->at<uint32_t>(TRANSITION_LOOKUP), file->count(TRANSITION_LOOKUP, 4),
+                       file->at<uint32_t>(TRANSITION_ID), file->at<char>(STRINGS), id);
+}
+
+PetriNet NetCache::toPetriNet() const {
+    PetriNet result;
+    const char* strings = file->at<char>(STRINGS);
+    const vector<int>& m0 = net.initialMarking();
+    result.places.resize(numPlaces());
+    for (int p = 0; p < numPlaces(); p++) {
+        result.places[p].id = placeId(p);
+        result.places[p].name = placeName(p);
+        result.places[p].initialMarking = m0[p];
+    }
+    result.transitions.resize(numTransitions());
+    for (int t = 0; t < numTransitions(); t++) {
+        result.transitions[t].id = transitionId(t);
+        result.transitions[t].name = transitionName(t);
+    }
+    const CachedArc* arcs = file->at<CachedArc>(ARCS);
+    result.arcs.resize(arcCount);
+    for (int i = 0; i < arcCount; i++) {
+        result.arcs[i].id = strings + arcs[i].id;
+        result.arcs[i].source = strings + arcs[i].source;
+        result.arcs[i].target = strings + arcs[i].target;
+        result.arcs[i].weight = arcs[i].weight;
+    }
+    result.symbols.build(result);
+    return result;
+}
+
+NetCache loadNetCached(const string& pnmlFile, const string& cacheFile) {
+    uint64_t sourceHash = hashFileContents(pnmlFile);
+    NetCache cache;
+    if (cache.open(cacheFile, sourceHash)) return cache;
+
+    PetriNet net = loadPNMLStream(pnmlFile);
+    verify(net);
+    writeNetCache(cacheFile, net, sourceHash);
+    if (!cache.open(cacheFile, sourceHash)) throw runtime_error("Cannot read back net cache: " + cacheFile);
+    return cache;
+}
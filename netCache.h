@@ -0,0 +1,59 @@
+#ifndef NET_CACHE_H
+#define NET_CACHE_H
+
+#include "compiledNet.h"
+#include <cstdint>
+
+/*
+ * Cache nhị phân của mạng đã biên dịch, đọc lại bằng mmap và dùng tại chỗ (zero-copy).
+ *
+ * File gồm header cố định rồi các section căn 8 byte: mảng CSR của CompiledNet (pre/post,
+ * consumers/producers/affected), marking ban đầu, cung gốc (place, transition, trọng số, id),
+ * bảng chuỗi id/name và 2 bảng băm open-addressing id -> chỉ số (bảng ký hiệu đã intern).
+ * Mở cache chỉ là mmap + kiểm tra header: CompiledNet trỏ thẳng vào vùng map, không parse gì.
+ *
+ * Header ghi hash nội dung file PNML nguồn; file PNML đổi (hoặc cache hỏng, khác phiên bản,
+ * khác endian) thì cache bị bỏ qua và ghi lại.
+ */
+
+//hash nội dung file (đọc theo khối, không phụ thuộc thời gian sửa file). Ném lỗi nếu không mở được
+uint64_t hashFileContents(const string& filename);
+
+//ghi net (đã verify) vào cacheFile, tạo thư mục cha nếu cần; ghi ra file tạm rồi rename nên
+//tiến trình khác không bao giờ thấy file ghi dở
+void writeNetCache(const string& cacheFile, const PetriNet& net, uint64_t sourceHash);
+
+struct MappedCacheFile; //netCache.cpp
+
+class NetCache {
+public:
+    //map cacheFile; false nếu không có file, sai định dạng hoặc sourceHash không khớp
+    bool open(const string& cacheFile, uint64_t sourceHash);
+    bool isOpen() const { return file != nullptr; }
+
+    //mảng CSR trỏ vào vùng map; bản copy giữ vùng map sống kể cả khi NetCache bị hủy
+    const CompiledNet& compiled() const { return net; }
+    int numPlaces() const { return net.numPlaces(); }
+    int numTransitions() const { return net.numTransitions(); }
+    int numArcs() const { return arcCount; }
+
+    const char* placeId(int p) const;
+    const char* placeName(int p) const;
+    const char* transitionId(int t) const;
+    const char* transitionName(int t) const;
+    int findPlace(const string& id) const;      //-1 nếu không có
+    int findTransition(const string& id) const; //-1 nếu không có
+
+    //dựng lại PetriNet (kèm bảng ký hiệu) cho các engine còn nhận PetriNet
+    PetriNet toPetriNet() const;
+
+private:
+    shared_ptr<const MappedCacheFile> file;
+    CompiledNet net = CompiledNet(0, 0, {}, CompiledArrays{}, nullptr);
+    int arcCount = 0;
+};
+
+//mở cacheFile nếu còn khớp với pnmlFile, ngược lại loadPNMLStream() + verify() rồi ghi cache mới
+NetCache loadNetCached(const string& pnmlFile, const string& cacheFile);
+
+#endif
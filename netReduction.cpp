@@ -0,0 +1,267 @@
+#include "netReduction.h"
+#include "compiledNet.h"
+#include <algorithm>
+#include <array>
+#include <map>
+#include <set>
+
+namespace {
+
+/*
+ * Mạng đang rút gọn: pre/post của mỗi transition dạng map place -> trọng số, adjacency
+ * place -> transition cập nhật cùng lúc, nên mỗi luật chỉ đụng tới phần tử liên quan.
+ */
+struct WorkingNet {
+    vector<map<int, int>> pre, post;
+    vector<set<int>> consumers, producers;
+    vector<int> m0;
+    vector<char> placeAlive, transAlive;
+    vector<PlaceOrigin> alias;     //place đã bỏ: giá trị = giá trị place alias + offset
+    vector<vector<int>> origin;    //chuỗi transition gốc của mỗi transition
+    ReductionStats stats;
+
+    explicit WorkingNet(const CompiledNet& compiled) {
+        int P = compiled.numPlaces(), T = compiled.numTransitions();
+        pre.assign(T, {});
+        post.assign(T, {});
+        consumers.assign(P, {});
+        producers.assign(P, {});
+        m0 = compiled.initialMarking();
+        placeAlive.assign(P, 1);
+        transAlive.assign(T, 1);
+        alias.resize(P);
+        origin.resize(T);
+        for (int p = 0; p < P; p++) alias[p] = {p, 0};
+        for (int t = 0; t < T; t++) {
+            origin[t] = {t};
+            for (const IncidenceEntry* e = compiled.preBegin(t); e != compiled.preEnd(t); ++e) {
+                pre[t][e->place] = e->weight;
+                consumers[e->place].insert(t);
+            }
+            for (const IncidenceEntry* e = compiled.postBegin(t); e != compiled.postEnd(t); ++e) {
+                post[t][e->place] = e->weight;
+                producers[e->place].insert(t);
+            }
+        }
+    }
+
+    static int weightOf(const map<int, int>& arcs, int p) {
+        auto it = arcs.find(p);
+        return it == arcs.end() ? 0 : it->second;
+    }
+
+    void addPost(int t, int p, int w) {
+        post[t][p] += w;
+        producers[p].insert(t);
+    }
+
+    void removeTransition(int t) {
+        for (const auto& e : pre[t]) consumers[e.first].erase(t);
+        for (const auto& e : post[t]) producers[e.first].erase(t);
+        pre[t].clear();
+        post[t].clear();
+        transAlive[t] = 0;
+    }
+
+    void removePlace(int p, int target, int offset) {
+        for (int t : consumers[p]) pre[t].erase(p);
+        for (int t : producers[p]) post[t].erase(p);
+        consumers[p].clear();
+        producers[p].clear();
+        placeAlive[p] = 0;
+        alias[p] = {target, offset};
+    }
+
+    //các transition chạm tới p, tăng dần
+    vector<int> touching(int p) const {
+        vector<int> result(consumers[p].begin(), consumers[p].end());
+        result.insert(result.end(), producers[p].begin(), producers[p].end());
+        sort(result.begin(), result.end());
+        result.erase(unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+    //p chỉ nằm trong self-loop và M0(p) đủ cho mọi cung vào transition: không bao giờ chặn gì
+    bool reduceSelfLoopPlaces() {
+        bool changed = false;
+        for (int p = 0; p < (int)m0.size(); p++) {
+            if (!placeAlive[p]) continue;
+            bool implicit = true;
+            for (int t : touching(p)) {
+                int w = weightOf(pre[t], p);
+                if (w != weightOf(post[t], p) || w > m0[p]) implicit = false;
+            }
+            if (!implicit) continue;
+            removePlace(p, -1, m0[p]);
+            stats.redundantPlaces++;
+            changed = true;
+        }
+        return changed;
+    }
+
+    //các place có cùng pre/post: giữ place ít token ban đầu nhất, các place khác = place đó + hằng
+    bool reduceDuplicatePlaces() {
+        bool changed = false;
+        map<vector<array<int, 3>>, int> kept;
+        for (int p = 0; p < (int)m0.size(); p++) {
+            if (!placeAlive[p]) continue;
+            vector<array<int, 3>> key;
+            for (int t : touching(p)) key.push_back({t, weightOf(pre[t], p), weightOf(post[t], p)});
+            if (key.empty()) continue;
+            auto it = kept.emplace(key, p).first;
+            if (it->second == p) continue;
+            int keep = it->second, drop = p;
+            if (m0[drop] < m0[keep]) {
+                swap(keep, drop);
+                it->second = keep;
+            }
+            removePlace(drop, keep, m0[drop] - m0[keep]);
+            stats.redundantPlaces++;
+            changed = true;
+        }
+        return changed;
+    }
+
+    bool reduceIdenticalTransitions() {
+        bool changed = false;
+        set<pair<vector<pair<int, int>>, vector<pair<int, int>>>> seen;
+        for (int t = 0; t < (int)pre.size(); t++) {
+            if (!transAlive[t]) continue;
+            auto key = make_pair(vector<pair<int, int>>(pre[t].begin(), pre[t].end()),
+                                 vector<pair<int, int>>(post[t].begin(), post[t].end()));
+            if (seen.insert(key).second) continue;
+            removeTransition(t);
+            stats.identicalTransitions++;
+            changed = true;
+        }
+        return changed;
+    }
+
+    //t: •t = {p1}, t• = {p2}, t là consumer duy nhất của p1 => gộp p1 vào p2
+    bool fuseSeriesPlaces() {
+        bool changed = false;
+        for (int t = 0; t < (int)pre.size(); t++) {
+            if (!transAlive[t] || pre[t].size() != 1 || post[t].size() != 1) continue;
+            auto [p1, w1] = *pre[t].begin();
+            auto [p2, w2] = *post[t].begin();
+            if (p1 == p2 || w1 != 1 || w2 != 1 || consumers[p1].size() != 1) continue;
+
+            removeTransition(t);
+            for (int u : producers[p1]) addPost(u, p2, post[u][p1]);
+            m0[p2] += m0[p1];
+            removePlace(p1, -1, 0);
+            stats.seriesPlaces++;
+            changed = true;
+        }
+        return changed;
+    }
+
+    //p: M0(p) = 0, •p = {t1}, p• = {t2}, •t2 = {p} => t1 fire kèm luôn t2
+    bool fuseSeriesTransitions() {
+        bool changed = false;
+        for (int p = 0; p < (int)m0.size(); p++) {
+            if (!placeAlive[p] || m0[p] != 0 || producers[p].size() != 1 || consumers[p].size() != 1) continue;
+            int t1 = *producers[p].begin(), t2 = *consumers[p].begin();
+            if (t1 == t2 || pre[t2].size() != 1 || pre[t2].begin()->second != 1 || post[t1][p] != 1) continue;
+
+            map<int, int> outputs = post[t2];
+            removeTransition(t2);
+            removePlace(p, -1, 0);
+            for (const auto& e : outputs) addPost(t1, e.first, e.second);
+            origin[t1].insert(origin[t1].end(), origin[t2].begin(), origin[t2].end());
+            stats.seriesTransitions++;
+            changed = true;
+        }
+        return changed;
+    }
+};
+
+}
+
+ReducedNet reduceNet(const PetriNet& net, const ReductionOptions& options) {
+    CompiledNet compiled(net);
+    WorkingNet work(compiled);
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        if (options.removeRedundantPlaces) {
+            changed |= work.reduceSelfLoopPlaces();
+            changed |= work.reduceDuplicatePlaces();
+        }
+        if (options.removeIdenticalTransitions) changed |= work.reduceIdenticalTransitions();
+        if (options.fuseSeries) {
+            changed |= work.fuseSeriesPlaces();
+            changed |= work.fuseSeriesTransitions();
+        }
+    }
+
+    ReducedNet result;
+    result.stats = work.stats;
+    int P = compiled.numPlaces(), T = compiled.numTransitions();
+    vector<int> newPlace(P, -1);
+    for (int p = 0; p < P; p++) {
+        if (!work.placeAlive[p]) continue;
+        newPlace[p] = result.net.places.size();
+        Place place = net.places[p];
+        place.initialMarking = work.m0[p];
+        result.net.places.push_back(place);
+    }
+    //nối chuỗi alias tới place còn lại (hoặc hằng số)
+    result.placeOrigin.resize(P);
+    for (int p = 0; p < P; p++) {
+        int q = p, offset = 0;
+        while (q >= 0 && !work.placeAlive[q]) {
+            offset += work.alias[q].offset;
+            q = work.alias[q].place;
+        }
+        result.placeOrigin[p] = {q < 0 ? -1 : newPlace[q], offset};
+    }
+
+    for (int t = 0; t < T; t++) {
+        if (!work.transAlive[t]) continue;
+        const Transition& trans = net.transitions[t];
+        result.net.transitions.push_back(trans);
+        result.transitionOrigin.push_back(work.origin[t]);
+        for (const auto& e : work.pre[t]) {
+            Arc arc;
+            arc.id = "r" + to_string(result.net.arcs.size());
+            arc.source = net.places[e.first].id;
+            arc.target = trans.id;
+            arc.weight = e.second;
+            result.net.arcs.push_back(arc);
+        }
+        for (const auto& e : work.post[t]) {
+            Arc arc;
+            arc.id = "r" + to_string(result.net.arcs.size());
+            arc.source = trans.id;
+            arc.target = net.places[e.first].id;
+            arc.weight = e.second;
+            result.net.arcs.push_back(arc);
+        }
+    }
+    result.net.symbols.build(result.net);
+    return result;
+}
+
+Marking ReducedNet::expand(const Marking& reduced) const {
+    Marking M;
+    M.tokens.resize(placeOrigin.size());
+    for (size_t p = 0; p < placeOrigin.size(); p++) {
+        const PlaceOrigin& o = placeOrigin[p];
+        M.tokens[p] = (o.place < 0 ? 0 : reduced.tokens[o.place]) + o.offset;
+    }
+    return M;
+}
+
+void printReductionInfo(const PetriNet& original, const ReducedNet& reduced) {
+    cout << "\n================ NET REDUCTION ================" << endl;
+    cout << "Places: " << original.places.size() << " -> " << reduced.net.places.size()
+         << " | Transitions: " << original.transitions.size() << " -> " << reduced.net.transitions.size()
+         << " | Arcs: " << original.arcs.size() << " -> " << reduced.net.arcs.size() << endl;
+    cout << "  Series places fused:      " << reduced.stats.seriesPlaces << endl;
+    cout << "  Series transitions fused: " << reduced.stats.seriesTransitions << endl;
+    cout << "  Redundant places removed: " << reduced.stats.redundantPlaces << endl;
+    cout << "  Identical transitions:    " << reduced.stats.identicalTransitions << endl;
+    cout << "================================================" << endl;
+}
@@ -0,0 +1,57 @@
+#ifndef NET_REDUCTION_H
+#define NET_REDUCTION_H
+
+#include "petriNet.h"
+
+//giá trị của một place gốc theo marking của mạng rút gọn: M(p) = M'(place) + offset, place = -1: hằng số offset
+struct PlaceOrigin {
+    int place;
+    int offset;
+};
+
+struct ReductionStats {
+    int seriesPlaces = 0;         //số place bị gộp vào place sau nó (bỏ transition ở giữa)
+    int seriesTransitions = 0;    //số transition bị gộp vào transition trước nó (bỏ place ở giữa)
+    int redundantPlaces = 0;      //place trùng lặp hoặc không bao giờ chặn transition nào
+    int identicalTransitions = 0; //transition có pre/post giống hệt một transition khác
+};
+
+struct ReductionOptions {
+    bool fuseSeries = true;
+    bool removeRedundantPlaces = true;
+    bool removeIdenticalTransitions = true;
+};
+
+struct ReducedNet {
+    PetriNet net;                         //mạng rút gọn, place/transition giữ id của phần tử gốc đại diện
+    vector<PlaceOrigin> placeOrigin;      //theo chỉ số place của mạng gốc
+    vector<vector<int>> transitionOrigin; //transition rút gọn -> chuỗi transition gốc fire liên tiếp
+    ReductionStats stats;
+
+    //marking của mạng gốc ứng với marking M' của mạng rút gọn (các place bị gộp đều rỗng)
+    Marking expand(const Marking& reduced) const;
+};
+
+/*
+ * Rút gọn cấu trúc kiểu Berthelot, lặp tới khi không luật nào áp dụng được. Các luật giữ nguyên
+ * câu hỏi "có marking chết reachable không": marking chết của mạng rút gọn, qua expand(), là marking
+ * chết reachable của mạng gốc và ngược lại. Tập reachable thì KHÔNG giữ nguyên (chỉ còn các marking
+ * "đã ổn định", token trong place bị gộp đã đi tiếp), nên không dùng để liệt kê marking.
+ *
+ *  - Gộp place nối tiếp: t có •t = {p1}, t• = {p2} (trọng số 1), p1 ≠ p2 và t là consumer duy nhất
+ *    của p1 => token vào p1 luôn đi tiếp sang p2: bỏ t, producer của p1 ghi thẳng vào p2.
+ *  - Gộp transition nối tiếp: p có M0(p) = 0, •p = {t1}, p• = {t2}, •t2 = {p} (trọng số 1) =>
+ *    t2 luôn fire được ngay sau t1: t1 nhận thêm output của t2, bỏ p và t2.
+ *  - Place thừa: p chỉ nằm trong self-loop (pre = post với mọi transition) và M0(p) đủ cho mọi cung
+ *    => không bao giờ chặn transition nào, bỏ (giá trị hằng M0). Place có pre/post giống hệt q và
+ *    M0(p) >= M0(q) => M(p) = M(q) + M0(p) - M0(q) luôn đúng, bỏ p.
+ *  - Transition trùng: cùng pre và post với một transition khác => bỏ.
+ *
+ * Mỗi marking reachable của mạng rút gọn, qua expand(), là marking reachable của mạng gốc (place còn
+ * lại giữ nguyên số token), nên mạng gốc 1-safe thì mạng rút gọn cũng 1-safe.
+ */
+ReducedNet reduceNet(const PetriNet& net, const ReductionOptions& options = ReductionOptions());
+
+void printReductionInfo(const PetriNet& original, const ReducedNet& reduced);
+
+#endif
@@ -0,0 +1,171 @@
+#include "packedNet.h"
+#include <cstring>
+#include <map>
+
+//AVX2 được biên dịch riêng cho từng hàm (target attribute) và chọn lúc chạy theo CPU,
+//nên không cần -mavx2 và binary vẫn chạy trên CPU không có AVX2
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PACKED_NET_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+#if defined(PACKED_NET_AVX2)
+//xử lý mask theo khối 4 word (gather 256-bit); trả về số mask đã xử lý, phần dư để vòng scalar làm
+__attribute__((target("avx2")))
+int enabledBlocksAvx2(const uint64_t* m, const int32_t* word, const uint64_t* pre, int count, bool& missing) {
+    __m256i acc = _mm256_setzero_si256();
+    int k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m128i idx = _mm_loadu_si128((const __m128i*)&word[k]);
+        __m256i v = _mm256_i32gather_epi64((const long long*)m, idx, 8);
+        __m256i p = _mm256_loadu_si256((const __m256i*)&pre[k]);
+        acc = _mm256_or_si256(acc, _mm256_xor_si256(_mm256_and_si256(v, p), p));
+    }
+    missing = !_mm256_testz_si256(acc, acc);
+    return k;
+}
+
+__attribute__((target("avx2")))
+int fireBlocksAvx2(const uint64_t* m, uint64_t* out, const int32_t* word, const uint64_t* pre,
+                   const uint64_t* post, int count, bool& overflow) {
+    __m256i acc = _mm256_setzero_si256();
+    alignas(32) uint64_t next[4];
+    int k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m128i idx = _mm_loadu_si128((const __m128i*)&word[k]);
+        __m256i v = _mm256_i32gather_epi64((const long long*)m, idx, 8);
+        __m256i p = _mm256_loadu_si256((const __m256i*)&pre[k]);
+        __m256i q = _mm256_loadu_si256((const __m256i*)&post[k]);
+        __m256i kept = _mm256_andnot_si256(p, v);
+        acc = _mm256_or_si256(acc, _mm256_and_si256(kept, q));
+        _mm256_store_si256((__m256i*)next, _mm256_or_si256(kept, q));
+        //AVX2 không có scatter: ghi lại từng word
+        for (int j = 0; j < 4; j++) out[word[k + j]] = next[j];
+    }
+    overflow = !_mm256_testz_si256(acc, acc);
+    return k;
+}
+#endif
+
+}
+
+bool PackedNet::usesAvx2() {
+#if defined(PACKED_NET_AVX2)
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+bool PackedNet::isSafeCandidate(const CompiledNet& net) {
+    for (int v : net.initialMarking())
+        if (v < 0 || v > 1) return false;
+    for (int t = 0; t < net.numTransitions(); t++) {
+        for (const IncidenceEntry* e = net.preBegin(t); e != net.preEnd(t); ++e)
+            if (e->weight != 1) return false;
+        for (const IncidenceEntry* e = net.postBegin(t); e != net.postEnd(t); ++e)
+            if (e->weight != 1) return false;
+    }
+    return true;
+}
+
+PackedNet::PackedNet(const CompiledNet& net) {
+    nPlaces = net.numPlaces();
+    nTransitions = net.numTransitions();
+    nWords = (nPlaces + 63) / 64;
+    if (nWords == 0) nWords = 1;
+    avx2 = usesAvx2();
+
+    maskOffsets.assign(nTransitions + 1, 0);
+    for (int t = 0; t < nTransitions; t++) {
+        //gom pre/post của t theo word, std::map giữ word tăng dần
+        map<int, pair<uint64_t, uint64_t>> touched;
+        for (const IncidenceEntry* e = net.preBegin(t); e != net.preEnd(t); ++e)
+            touched[e->place / 64].first |= 1ULL << (e->place % 64);
+        for (const IncidenceEntry* e = net.postBegin(t); e != net.postEnd(t); ++e)
+            touched[e->place / 64].second |= 1ULL << (e->place % 64);
+
+        for (const auto& w : touched) {
+            maskWord.push_back(w.first);
+            preMask.push_back(w.second.first);
+            postMask.push_back(w.second.second);
+        }
+        maskOffsets[t + 1] = maskWord.size();
+    }
+}
+
+void PackedNet::pack(const int* tokens, uint64_t* out) const {
+    memset(out, 0, nWords * sizeof(uint64_t));
+    for (int p = 0; p < nPlaces; p++)
+        if (tokens[p] > 0) out[p / 64] |= 1ULL << (p % 64);
+}
+
+void PackedNet::unpack(const uint64_t* m, int* tokens) const {
+    for (int p = 0; p < nPlaces; p++)
+        tokens[p] = (m[p / 64] >> (p % 64)) & 1ULL;
+}
+
+PackedMarking PackedNet::pack(const Marking& M) const {
+    PackedMarking P;
+    P.words.resize(nWords);
+    pack(M.tokens.data(), P.words.data());
+    return P;
+}
+
+Marking PackedNet::unpack(const PackedMarking& M) const {
+    Marking U;
+    U.tokens.resize(nPlaces);
+    unpack(M.words.data(), U.tokens.data());
+    return U;
+}
+
+bool PackedNet::isEnabled(const uint64_t* m, int t) const {
+    int k = maskOffsets[t];
+    int end = maskOffsets[t + 1];
+    uint64_t missing = 0;
+#if defined(PACKED_NET_AVX2)
+    if (avx2 && end - k >= 4) {
+        bool blocked;
+        k += enabledBlocksAvx2(m, &maskWord[k], &preMask[k], end - k, blocked);
+        if (blocked) return false;
+    }
+#endif
+    for (; k < end; k++)
+        missing |= (m[maskWord[k]] & preMask[k]) ^ preMask[k];
+    return missing == 0;
+}
+
+bool PackedNet::fire(const uint64_t* m, uint64_t* out, int t) const {
+    memcpy(out, m, nWords * sizeof(uint64_t));
+    int k = maskOffsets[t];
+    int end = maskOffsets[t + 1];
+    uint64_t overflow = 0;
+#if defined(PACKED_NET_AVX2)
+    if (avx2 && end - k >= 4) {
+        bool collided;
+        k += fireBlocksAvx2(m, out, &maskWord[k], &preMask[k], &postMask[k], end - k, collided);
+        if (collided) overflow = 1;
+    }
+#endif
+    for (; k < end; k++) {
+        uint64_t kept = m[maskWord[k]] & ~preMask[k];
+        overflow |= kept & postMask[k];
+        out[maskWord[k]] = kept | postMask[k];
+    }
+    return overflow == 0;
+}
+
+bool isEnabled(const PackedMarking& M, int t, const PackedNet& net) {
+    return net.isEnabled(M.words.data(), t);
+}
+
+PackedMarking fire(const PackedMarking& M, int t, const PackedNet& net) {
+    PackedMarking M2;
+    M2.words.resize(net.numWords());
+    if (!net.fire(M.words.data(), M2.words.data(), t))
+        throw runtime_error("Firing produces more than one token in a place: net is not 1-safe");
+    return M2;
+}
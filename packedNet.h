@@ -0,0 +1,65 @@
+#ifndef PACKED_NET_H
+#define PACKED_NET_H
+
+#include "compiledNet.h"
+#include <cstdint>
+
+//marking của mạng 1-safe: 1 bit / place, place i nằm ở bit (i % 64) của word (i / 64)
+struct PackedMarking {
+    vector<uint64_t> words;
+    bool operator==(const PackedMarking& other) const {
+        return words == other.words;
+    }
+};
+
+/*
+ * PackedNet: dạng bit-packed của CompiledNet cho mạng 1-safe.
+ *
+ * Mỗi transition chỉ lưu các word mà pre/post của nó chạm tới (CSR theo transition):
+ *   (chỉ số word, preMask, postMask).
+ * - enabled:  (m & pre) == pre trên mọi word đó
+ * - fire:     m' = (m & ~pre) | post
+ * Cả hai không rẽ nhánh theo từng place; trên CPU x86-64 có AVX2 (kiểm tra lúc chạy) các word
+ * được xử lý 4 word một lần bằng gather 256-bit.
+ *
+ * Chỉ dùng được khi mọi trọng số cung = 1 và M0 chỉ có 0/1 (isSafeCandidate). Tính an toàn
+ * thật sự được kiểm tra trong lúc fire: nếu post đặt token vào place đã có token thì fire()
+ * báo lỗi để engine quay về dạng vector<int>.
+ */
+class PackedNet {
+public:
+    explicit PackedNet(const CompiledNet& net);
+
+    //điều kiện cần để dùng dạng bit: trọng số 1 và M0 <= 1 ở mọi place
+    static bool isSafeCandidate(const CompiledNet& net);
+
+    int numPlaces() const { return nPlaces; }
+    int numTransitions() const { return nTransitions; }
+    int numWords() const { return nWords; }
+    //CPU đang chạy hỗ trợ AVX2 và isEnabled()/fire() dùng đường 256-bit
+    static bool usesAvx2();
+
+    void pack(const int* tokens, uint64_t* out) const;
+    void unpack(const uint64_t* m, int* tokens) const;
+    PackedMarking pack(const Marking& M) const;
+    Marking unpack(const PackedMarking& M) const;
+
+    bool isEnabled(const uint64_t* m, int t) const;
+    //ghi m' = (m & ~pre) | post vào out (out khác m). Trả về false nếu m' vượt 1 token ở 1 place (mạng không safe)
+    bool fire(const uint64_t* m, uint64_t* out, int t) const;
+
+private:
+    int nPlaces;
+    int nTransitions;
+    int nWords;
+    bool avx2;
+    vector<int> maskOffsets;      //mask của t: [maskOffsets[t], maskOffsets[t+1])
+    vector<int32_t> maskWord;     //chỉ số word
+    vector<uint64_t> preMask;
+    vector<uint64_t> postMask;
+};
+
+bool isEnabled(const PackedMarking& M, int t, const PackedNet& net);
+PackedMarking fire(const PackedMarking& M, int t, const PackedNet& net);
+
+#endif
@@ -0,0 +1,299 @@
+#include "parallelExplorer.h"
+#include "explicitModels.h"
+#include "stateStore.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+//bộ nhớ state của 1 thread: cấp phát theo chunk, địa chỉ record không bao giờ đổi.
+//Record = [fingerprint 8 byte][state]
+class StateArena {
+public:
+    explicit StateArena(size_t recordBytes) : recordBytes(recordBytes) {
+        chunkBytes = max<size_t>(1 << 20, recordBytes * 64) / recordBytes * recordBytes;
+        used = chunkBytes;
+    }
+    unsigned char* allocate() {
+        if (used + recordBytes > chunkBytes) {
+            chunks.emplace_back(new unsigned char[chunkBytes]);
+            used = 0;
+        }
+        unsigned char* r = chunks.back().get() + used;
+        used += recordBytes;
+        return r;
+    }
+    //trả lại record vừa cấp phát gần nhất (khi thread khác đã chèn cùng state trước)
+    void releaseLast() { used -= recordBytes; }
+private:
+    size_t recordBytes;
+    size_t chunkBytes;
+    size_t used;
+    vector<unique_ptr<unsigned char[]>> chunks;
+};
+
+//bảng visited dùng chung, chèn bằng CAS trên slot, không khóa
+template <typename Word>
+class ConcurrentVisitedTable {
+public:
+    enum Result { Inserted, Found, Full };
+
+    ConcurrentVisitedTable(int width, size_t capacity) : width(width) { allocate(capacity); }
+
+    static uint64_t fingerprintOf(const unsigned char* r) { return *reinterpret_cast<const uint64_t*>(r); }
+    static const Word* stateOf(const unsigned char* r) { return reinterpret_cast<const Word*>(r + sizeof(uint64_t)); }
+    static size_t recordBytes(int width) {
+        return sizeof(uint64_t) + (width * sizeof(Word) + 7) / 8 * 8;
+    }
+
+    //Full: bảng đã quá tải, state chưa được chèn, caller phải hoãn lại tới cuối mức
+    Result insert(const Word* state, StateArena& arena, const unsigned char*& record) {
+        if (count.load(memory_order_relaxed) >= limit) return Full;
+        uint64_t fp = hashState(state, width);
+        size_t pos = fp & mask;
+        unsigned char* mine = nullptr;
+        while (true) {
+            const unsigned char* cur = slots[pos].load(memory_order_acquire);
+            if (!cur) {
+                if (!mine) {
+                    mine = arena.allocate();
+                    *reinterpret_cast<uint64_t*>(mine) = fp;
+                    copy(state, state + width, reinterpret_cast<Word*>(mine + sizeof(uint64_t)));
+                }
+                if (slots[pos].compare_exchange_strong(cur, mine, memory_order_acq_rel, memory_order_acquire)) {
+                    count.fetch_add(1, memory_order_relaxed);
+                    record = mine;
+                    return Inserted;
+                }
+                //thua CAS: cur giờ là record của thread thắng, so sánh tiếp bên dưới
+            }
+            if (fingerprintOf(cur) == fp && equal(state, state + width, stateOf(cur))) {
+                if (mine) arena.releaseLast();
+                record = cur;
+                return Found;
+            }
+            pos = (pos + 1) & mask;
+        }
+    }
+
+    size_t size() const { return count.load(); }
+    size_t capacity() const { return mask + 1; }
+
+    //chỉ gọi khi không có thread nào đang chèn (giữa 2 mức BFS)
+    void rehash(size_t newCapacity, const vector<const unsigned char*>& records) {
+        allocate(newCapacity);
+        for (const unsigned char* r : records) {
+            size_t pos = fingerprintOf(r) & mask;
+            while (slots[pos].load(memory_order_relaxed)) pos = (pos + 1) & mask;
+            slots[pos].store(r, memory_order_relaxed);
+        }
+        count.store(records.size());
+    }
+
+private:
+    int width;
+    unique_ptr<atomic<const unsigned char*>[]> slots;
+    size_t mask;
+    size_t limit;
+    atomic<size_t> count{0};
+
+    void allocate(size_t capacity) {
+        size_t cap = 1024;
+        while (cap < capacity) cap <<= 1;
+        slots.reset(new atomic<const unsigned char*>[cap]);
+        for (size_t i = 0; i < cap; i++) slots[i].store(nullptr, memory_order_relaxed);
+        mask = cap - 1;
+        limit = cap - cap / 8; //chừa chỗ để các thread đang chèn dở vẫn tìm được slot trống
+        count.store(0);
+    }
+};
+
+class Barrier {
+public:
+    explicit Barrier(int n) : n(n) {}
+    void wait() {
+        unique_lock<mutex> lk(m);
+        size_t gen = generation;
+        if (++waiting == n) {
+            waiting = 0;
+            generation++;
+            cv.notify_all();
+        } else {
+            cv.wait(lk, [&] { return gen != generation; });
+        }
+    }
+private:
+    mutex m;
+    condition_variable cv;
+    int n;
+    int waiting = 0;
+    size_t generation = 0;
+};
+
+//frontier của 1 thread: chủ lấy ở cuối, thread khác lấy trộm nửa đầu
+struct WorkQueue {
+    mutex lock;
+    deque<const unsigned char*> items;
+};
+
+//Khám phá song song với Model (IntModel/PackedModel). Trả về false nếu Model báo firing không hợp lệ.
+template <typename Model>
+bool explore(const Model& model, int numThreads, vector<Marking>& result) {
+    typedef typename Model::Word Word;
+    typedef ConcurrentVisitedTable<Word> Table;
+    int W = model.width();
+    size_t recBytes = Table::recordBytes(W);
+
+    Table table(W, 1 << 16);
+    vector<unique_ptr<StateArena>> arenas;
+    vector<unique_ptr<WorkQueue>> queues;
+    vector<vector<const unsigned char*>> next(numThreads);   //state mới của mức sau, theo thread
+    vector<vector<Word>> deferred(numThreads);               //state gặp lúc bảng quá tải, nối liền nhau
+    for (int i = 0; i < numThreads; i++) {
+        arenas.emplace_back(new StateArena(recBytes));
+        queues.emplace_back(new WorkQueue());
+    }
+
+    vector<const unsigned char*> order; //mọi record theo thứ tự mức BFS
+    atomic<bool> invalid(false);
+    bool done = false;
+
+    vector<Word> m0(W);
+    model.initial(m0.data());
+    const unsigned char* rec = nullptr;
+    table.insert(m0.data(), *arenas[0], rec);
+    order.push_back(rec);
+    queues[0]->items.push_back(rec);
+
+    Barrier barrier(numThreads + 1);
+
+    auto steal = [&](int self) -> const unsigned char* {
+        for (int k = 1; k < numThreads; k++) {
+            WorkQueue& victim = *queues[(self + k) % numThreads];
+            vector<const unsigned char*> loot;
+            {
+                lock_guard<mutex> g(victim.lock);
+                size_t n = victim.items.size();
+                if (n == 0) continue;
+                size_t take = (n + 1) / 2;
+                loot.assign(victim.items.begin(), victim.items.begin() + take);
+                victim.items.erase(victim.items.begin(), victim.items.begin() + take);
+            }
+            const unsigned char* first = loot.back();
+            loot.pop_back();
+            if (!loot.empty()) {
+                lock_guard<mutex> g(queues[self]->lock);
+                queues[self]->items.insert(queues[self]->items.end(), loot.begin(), loot.end());
+            }
+            return first;
+        }
+        return nullptr;
+    };
+
+    auto worker = [&](int self) {
+        vector<Word> succ(W);
+        WorkQueue& own = *queues[self];
+        while (true) {
+            barrier.wait(); //đầu mức
+            if (done) return;
+            while (!invalid.load(memory_order_relaxed)) {
+                const unsigned char* curr = nullptr;
+                {
+                    lock_guard<mutex> g(own.lock);
+                    if (!own.items.empty()) {
+                        curr = own.items.back();
+                        own.items.pop_back();
+                    }
+                }
+                if (!curr) curr = steal(self);
+                //trong 1 mức không sinh thêm việc cho mức hiện tại, nên mọi queue rỗng = xong mức
+                if (!curr) break;
+
+                const Word* state = Table::stateOf(curr);
+                for (int t = 0; t < model.numTransitions(); t++) {
+                    if (!model.isEnabled(state, t)) continue;
+                    if (!model.fire(state, succ.data(), t)) {
+                        invalid.store(true);
+                        break;
+                    }
+                    const unsigned char* r = nullptr;
+                    typename Table::Result res = table.insert(succ.data(), *arenas[self], r);
+                    if (res == Table::Inserted) next[self].push_back(r);
+                    else if (res == Table::Full) deferred[self].insert(deferred[self].end(), succ.begin(), succ.end());
+                }
+            }
+            barrier.wait(); //cuối mức
+        }
+    };
+
+    vector<thread> threads;
+    for (int i = 0; i < numThreads; i++) threads.emplace_back(worker, i);
+
+    while (true) {
+        //giữ load factor <= 0.5 đầu mỗi mức để ít khi phải hoãn state
+        if (table.size() * 2 > table.capacity()) table.rehash(table.size() * 4, order);
+
+        barrier.wait();
+        barrier.wait();
+        if (invalid) break;
+
+        for (auto& lv : next) order.insert(order.end(), lv.begin(), lv.end());
+
+        //state bị hoãn vì bảng quá tải: nới bảng rồi chèn tuần tự (các worker đang chờ ở barrier)
+        size_t pending = 0;
+        if (W > 0)
+            for (auto& d : deferred) pending += d.size() / W;
+        if (pending > 0) {
+            table.rehash((order.size() + pending) * 2, order);
+            for (int i = 0; i < numThreads; i++) {
+                for (size_t k = 0; k < deferred[i].size(); k += W) {
+                    const unsigned char* r = nullptr;
+                    if (table.insert(deferred[i].data() + k, *arenas[0], r) == Table::Inserted) {
+                        next[0].push_back(r);
+                        order.push_back(r);
+                    }
+                }
+                deferred[i].clear();
+            }
+        }
+
+        bool empty = true;
+        for (int i = 0; i < numThreads; i++) {
+            if (!next[i].empty()) empty = false;
+            queues[i]->items.assign(next[i].begin(), next[i].end());
+            next[i].clear();
+        }
+        if (empty) break;
+    }
+
+    done = true;
+    barrier.wait();
+    for (auto& th : threads) th.join();
+    if (invalid) return false;
+
+    result.assign(order.size(), Marking());
+    for (size_t i = 0; i < order.size(); i++)
+        model.decode(Table::stateOf(order[i]), result[i]);
+    return true;
+}
+
+}
+
+vector<Marking> parallelBFS(const PetriNet& net, int numThreads) {
+    CompiledNet compiled(net);
+    return parallelBFS(compiled, numThreads);
+}
+
+vector<Marking> parallelBFS(const CompiledNet& net, int numThreads) {
+    if (numThreads <= 0) numThreads = max(1u, thread::hardware_concurrency());
+
+    vector<Marking> result;
+    if (PackedNet::isSafeCandidate(net) && explore(PackedModel(net), numThreads, result))
+        return result;
+    explore(IntModel(net), numThreads, result);
+    return result;
+}
@@ -0,0 +1,24 @@
+#ifndef PARALLEL_EXPLORER_H
+#define PARALLEL_EXPLORER_H
+
+#include "petriNet.h"
+#include "compiledNet.h"
+
+/*
+ * Khám phá không gian trạng thái tường minh bằng nhiều thread.
+ *
+ * - Tập visited là bảng băm open-addressing dùng chung, không khóa: mỗi slot là một con trỏ
+ *   atomic, thread chèn state bằng compare-and-swap. State được ghi vào arena riêng của
+ *   thread tạo ra nó nên địa chỉ không đổi trong suốt quá trình chạy.
+ * - Mỗi thread có frontier riêng; thread hết việc sẽ lấy trộm (work stealing) một nửa
+ *   frontier của thread khác.
+ * - Chạy theo từng mức BFS (barrier giữa các mức), nên tập marking và số state giống hệt
+ *   BFS(); kết quả được trả về theo thứ tự mức, M0 đứng đầu. Mạng dạng 1-safe dùng marking
+ *   bit-packed như BFS().
+ *
+ * numThreads <= 0: dùng std::thread::hardware_concurrency().
+ */
+vector<Marking> parallelBFS(const PetriNet& net, int numThreads = 0);
+vector<Marking> parallelBFS(const CompiledNet& net, int numThreads = 0);
+
+#endif
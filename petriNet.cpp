@@ -1,4 +1,14 @@
 #include "petriNet.h"
+#include "compiledNet.h"
+#include "explicitModels.h"
+#include "pnmlStream.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <thread>
 
 int findPlace(const vector<Place>& places, const string& id) {
     for (size_t i = 0; i < places.size(); ++i) {
@@ -14,30 +24,111 @@ int findTransition(const vector<Transition>& transitions, const string& id) {
     return -1;
 }
 
-/*
-Chức năng: load file PNML
-Đầu vào: const string& filename
-Đầu ra: PetriNet
-(Ctrl+click để xem chi tiết)
-*/
-PetriNet loadPNML(const string& filename) {
-    PetriNet net;                                                                //PetriNet sẽ được trả về
-    XMLDocument doc;                                                             //XMLDocument offer hàng ngàn tính năng đọc XML và thao tác trên cấu trúc XML đã parsed
-    if (doc.LoadFile(filename.c_str()) != XML_SUCCESS)                           //Hàm LoadFile() làm 3 việc: đọc file, parse file, check lỗi
-        throw runtime_error("Cannot open PNML file or XML format error!");       //quăng lỗi (nếu ko đọc được) và chương trình dừng lại.
+void SymbolTable::build(const PetriNet& net) {
+    placeIndex.clear();
+    transitionIndex.clear();
+    placeIndex.reserve(net.places.size());
+    transitionIndex.reserve(net.transitions.size());
+    for (size_t i = 0; i < net.places.size(); i++)
+        placeIndex.emplace(net.places[i].id, i);
+    for (size_t i = 0; i < net.transitions.size(); i++)
+        transitionIndex.emplace(net.transitions[i].id, i);
+    numPlaces = net.places.size();
+    numTransitions = net.transitions.size();
+}
 
-    XMLElement* pnml = doc.FirstChildElement("pnml");                            //địa chỉ dẫn đến <pnml> tag trong simple_example>pnml
-    if (!pnml) throw runtime_error("Invalid PNML: missing <pnml>");              //quăng lỗi ko thấy <pnml>
+int SymbolTable::place(const string& id) const {
+    auto it = placeIndex.find(id);
+    return it == placeIndex.end() ? -1 : it->second;
+}
 
-    XMLElement* netTag = pnml->FirstChildElement("net");                         //địa chỉ <net> tag trong simple_example.pnml
-    if (!netTag) throw runtime_error("Invalid PNML: missing <net>");             //quăng lỗi ko thấy <net>
+int SymbolTable::transition(const string& id) const {
+    auto it = transitionIndex.find(id);
+    return it == transitionIndex.end() ? -1 : it->second;
+}
+
+//index khớp với elements: mỗi id trỏ tới lần xuất hiện đầu tiên của nó và không còn id nào đã bị đổi/xóa
+template <typename Element>
+static bool indexMatches(const unordered_map<string, int>& index, const vector<Element>& elements) {
+    size_t firstOccurrences = 0;
+    for (size_t i = 0; i < elements.size(); i++) {
+        auto it = index.find(elements[i].id);
+        if (it == index.end() || it->second > (int)i || elements[it->second].id != elements[i].id) return false;
+        if (it->second == (int)i) firstOccurrences++;
+    }
+    return firstOccurrences == index.size();
+}
+
+bool SymbolTable::covers(const PetriNet& net) const {
+    return numPlaces == net.places.size() && numTransitions == net.transitions.size() &&
+           indexMatches(placeIndex, net.places) && indexMatches(transitionIndex, net.transitions);
+}
 
-    XMLElement* rootNode = netTag->FirstChildElement("page");                    //địa chỉ <page> tag 
-    if (!rootNode) rootNode = netTag;                                            //quăng lỗi ko thấy <page>
+const SymbolTable& symbolsOf(const PetriNet& net, SymbolTable& scratch) {
+    if (net.symbols.covers(net)) return net.symbols;
+    scratch.build(net);
+    return scratch;
+}
+
+PetriNet mergePnmlPages(vector<PnmlPage> pages) {
+    PetriNet net;
+    size_t numPlaces = 0, numTransitions = 0, numArcs = 0;
+    for (const auto& page : pages) {
+        numPlaces += page.places.size();
+        numTransitions += page.transitions.size();
+        numArcs += page.arcs.size();
+    }
+    net.places.reserve(numPlaces);
+    net.transitions.reserve(numTransitions);
+    net.arcs.reserve(numArcs);
+    for (auto& page : pages) {
+        move(page.places.begin(), page.places.end(), back_inserter(net.places));
+        move(page.transitions.begin(), page.transitions.end(), back_inserter(net.transitions));
+    }
+    net.symbols.build(net);
+
+    //reference node -> node thật (ref có thể trỏ tới reference node khác, nối chuỗi tới cuối)
+    unordered_map<string, string> placeRefs, transitionRefs, alias;
+    for (const auto& page : pages) {
+        placeRefs.insert(page.referencePlaces.begin(), page.referencePlaces.end());
+        transitionRefs.insert(page.referenceTransitions.begin(), page.referenceTransitions.end());
+    }
+    auto resolve = [&](const unordered_map<string, string>& refs, bool isPlace) {
+        for (const auto& r : refs) {
+            string id = r.second;
+            for (size_t steps = 0; refs.count(id); steps++) {
+                if (steps == refs.size()) throw runtime_error("Invalid PNML: cyclic reference " + r.first);
+                id = refs.at(id);
+            }
+            int index = isPlace ? net.symbols.place(id) : net.symbols.transition(id);
+            if (index == -1)
+                throw runtime_error("Invalid PNML: reference " + r.first + " points to unknown " +
+                                    (isPlace ? "place " : "transition ") + id);
+            alias.emplace(r.first, id);
+        }
+    };
+    resolve(placeRefs, true);
+    resolve(transitionRefs, false);
+
+    for (auto& page : pages) {
+        for (auto& arc : page.arcs) {
+            auto src = alias.find(arc.source);
+            if (src != alias.end()) arc.source = src->second;
+            auto tgt = alias.find(arc.target);
+            if (tgt != alias.end()) arc.target = tgt->second;
+            net.arcs.push_back(std::move(arc));
+        }
+    }
+    return net;
+}
+
+//đọc các phần tử con trực tiếp của 1 page (hoặc của <net>); chỉ đọc DOM nên gọi song song được
+static PnmlPage readPnmlPage(const XMLElement* node) {
+    PnmlPage page;
 
     // ----- Đọc Places -----
 
-    for (XMLElement* p = rootNode->FirstChildElement("place"); p; p = p->NextSiblingElement("place")) {
+    for (const XMLElement* p = node->FirstChildElement("place"); p; p = p->NextSiblingElement("place")) {
         //vòng lặp p từ <place> đầu tiên đến <place> cuối cùng. 
         //Giải thích: p đi từ first child, lặp đi lặp lại duyệt qua các sibling rồi kết thúc khi p == nullptr.
         
@@ -49,7 +140,8 @@ PetriNet loadPNML(const string& filename) {
         // name
         if (auto nameTag = p->FirstChildElement("name")) {                       //child đầu tiên, có first child là name (nếu)
             if (auto textTag = nameTag->FirstChildElement("text"))               //trong nameTag có text (nếu)
-                place.name = textTag->GetText();                                 //cập nhật place.name = textTag->GetText(); <name><text>Start</text></name> "Start"
+                if (const char* text = textTag->GetText())                       //null nếu con đầu tiên của <text> là element
+                    place.name = text;                                           //cập nhật place.name = textTag->GetText(); <name><text>Start</text></name> "Start"
         }
 
         // initial marking
@@ -63,11 +155,11 @@ PetriNet loadPNML(const string& filename) {
             place.initialMarking = 0;
         }
 
-        net.places.push_back(place);
+        page.places.push_back(place);
     }
 
     // ----- Đọc Transitions -----
-    for (XMLElement* t = rootNode->FirstChildElement("transition"); t; t = t->NextSiblingElement("transition")) {
+    for (const XMLElement* t = node->FirstChildElement("transition"); t; t = t->NextSiblingElement("transition")) {
         Transition trans;
         const char* idAttr = t->Attribute("id");
         if (!idAttr) continue;
@@ -75,14 +167,14 @@ PetriNet loadPNML(const string& filename) {
 
         if (auto nameTag = t->FirstChildElement("name")) {
             if (auto textTag = nameTag->FirstChildElement("text"))
-                trans.name = textTag->GetText();
+                if (const char* text = textTag->GetText()) trans.name = text;
         }
 
-        net.transitions.push_back(trans);
+        page.transitions.push_back(trans);
     }
 
     // ----- Đọc Arcs -----
-    for (XMLElement* a = rootNode->FirstChildElement("arc"); a; a = a->NextSiblingElement("arc")) {
+    for (const XMLElement* a = node->FirstChildElement("arc"); a; a = a->NextSiblingElement("arc")) {
         Arc arc;
         const char* idAttr = a->Attribute("id");
         const char* srcAttr = a->Attribute("source");
@@ -93,37 +185,94 @@ PetriNet loadPNML(const string& filename) {
         if (tgtAttr) arc.target = tgtAttr;
 
         if (!arc.source.empty() && !arc.target.empty()) {
-            net.arcs.push_back(arc);
+            page.arcs.push_back(arc);
         }
     }
 
-    return net;
+    // ----- Đọc reference place/transition (trỏ tới node ở page khác) -----
+    for (const XMLElement* r = node->FirstChildElement(); r; r = r->NextSiblingElement()) {
+        const char* idAttr = r->Attribute("id");
+        const char* refAttr = r->Attribute("ref");
+        if (!idAttr || !refAttr) continue;
+        if (strcmp(r->Name(), "referencePlace") == 0) page.referencePlaces.push_back({idAttr, refAttr});
+        else if (strcmp(r->Name(), "referenceTransition") == 0) page.referenceTransitions.push_back({idAttr, refAttr});
+    }
+    return page;
+}
+
+//<net> rồi mọi <page> lồng bên trong, theo thứ tự tài liệu (duyệt sâu, page cha trước page con)
+static void collectPages(const XMLElement* node, vector<const XMLElement*>& pages) {
+    pages.push_back(node);
+    for (const XMLElement* child = node->FirstChildElement("page"); child; child = child->NextSiblingElement("page"))
+        collectPages(child, pages);
+}
+
+/*
+Chức năng: load file PNML
+Đầu vào: const string& filename
+Đầu ra: PetriNet
+(Ctrl+click để xem chi tiết)
+*/
+PetriNet loadPNML(const string& filename) {
+    //file nén: tinyxml2 cần cả tài liệu trong bộ nhớ, nên giải nén streaming qua loader pull parser (cùng ngữ nghĩa)
+    if (isGzipFile(filename)) return loadPNMLStream(filename);
+
+    XMLDocument doc;                                                             //XMLDocument offer hàng ngàn tính năng đọc XML và thao tác trên cấu trúc XML đã parsed
+    if (doc.LoadFile(filename.c_str()) != XML_SUCCESS)                           //Hàm LoadFile() làm 3 việc: đọc file, parse file, check lỗi
+        throw runtime_error("Cannot open PNML file or XML format error!");       //quăng lỗi (nếu ko đọc được) và chương trình dừng lại.
+
+    XMLElement* pnml = doc.FirstChildElement("pnml");                            //địa chỉ dẫn đến <pnml> tag trong simple_example>pnml
+    if (!pnml) throw runtime_error("Invalid PNML: missing <pnml>");              //quăng lỗi ko thấy <pnml>
+
+    XMLElement* netTag = pnml->FirstChildElement("net");                         //địa chỉ <net> tag trong simple_example.pnml
+    if (!netTag) throw runtime_error("Invalid PNML: missing <net>");             //quăng lỗi ko thấy <net>
+
+    vector<const XMLElement*> pageNodes;
+    collectPages(netTag, pageNodes);
+
+    //các page độc lập: đọc song song, mỗi thread lấy page kế tiếp chưa ai đọc
+    vector<PnmlPage> pages(pageNodes.size());
+    atomic<size_t> nextPage(0);
+    exception_ptr failure;
+    mutex failureLock;
+    auto worker = [&]() {
+        for (size_t i; (i = nextPage.fetch_add(1)) < pageNodes.size();) {
+            try {
+                pages[i] = readPnmlPage(pageNodes[i]);
+            } catch (...) {
+                lock_guard<mutex> guard(failureLock);
+                if (!failure) failure = current_exception();
+            }
+        }
+    };
+    size_t numThreads = min<size_t>(pageNodes.size(), max(1u, thread::hardware_concurrency()));
+    vector<thread> threads;
+    for (size_t i = 1; i < numThreads; i++) threads.emplace_back(worker);
+    worker();
+    for (auto& th : threads) th.join();
+    if (failure) rethrow_exception(failure);
+
+    return mergePnmlPages(std::move(pages));
 }
 
 void verify(const PetriNet& net) {
-    // Kiểm tra trùng id place
+    SymbolTable scratch;
+    const SymbolTable& symbols = symbolsOf(net, scratch);
+
+    // Kiểm tra trùng id place: bảng giữ place đầu tiên của mỗi id, place sau trùng id sẽ không khớp chỉ số
     for (size_t i = 0; i < net.places.size(); i++) {
-        for (size_t j = i + 1; j < net.places.size(); j++) {
-            if (net.places[i].id == net.places[j].id)
-                throw runtime_error("Duplicate place ID detected: " + net.places[i].id);
-        }
+        if (symbols.place(net.places[i].id) != (int)i)
+            throw runtime_error("Duplicate place ID detected: " + net.places[i].id);
     }
 
     // Kiểm tra arc tham chiếu hợp lệ
     for (const auto& arc : net.arcs) {
-        bool sourceExists = false;
-        bool targetExists = false;
-
         // Check Source
-        if (findPlace(net.places, arc.source) != -1) sourceExists = true;
-        else if (findTransition(net.transitions, arc.source) != -1) sourceExists = true;
-
+        bool sourceExists = symbols.place(arc.source) != -1 || symbols.transition(arc.source) != -1;
         if (!sourceExists) throw runtime_error("Arc " + arc.id + " source not found: " + arc.source);
 
         // Check Target
-        if (findPlace(net.places, arc.target) != -1) targetExists = true;
-        else if (findTransition(net.transitions, arc.target) != -1) targetExists = true;
-
+        bool targetExists = symbols.place(arc.target) != -1 || symbols.transition(arc.target) != -1;
         if (!targetExists) throw runtime_error("Arc " + arc.id + " target not found: " + arc.target);
     }
 }
@@ -162,21 +311,17 @@ void printPetriNetInfo(const PetriNet& net) {
 
 //===================================== Xây bảng in/out arcs =================================================
 void buildTables(const PetriNet& net, vector<vector<pair<int,int>>>& inArcs, vector<vector<pair<int,int>>>& outArcs) {
-    int T = net.transitions.size();
+    //tra id qua CompiledNet (bảng ký hiệu băm của net) thay vì findPlace/findTransition cho từng arc
+    CompiledNet compiled(net);
+    int T = compiled.numTransitions();
     inArcs.assign(T, {});
     outArcs.assign(T, {});
 
-    for (auto& arc : net.arcs) {
-        int placeSource = findPlace(net.places, arc.source);
-        int placeTarget = findPlace(net.places, arc.target);
-        int transScource = findTransition(net.transitions, arc.source);
-        int transTarget = findTransition(net.transitions, arc.target);
-
-        if (placeSource != -1 && transTarget != -1)
-            inArcs[transTarget].push_back({placeSource, arc.weight});
-
-        if (transScource != -1 && placeTarget != -1)
-            outArcs[transScource].push_back({placeTarget, arc.weight});
+    for (int t = 0; t < T; t++) {
+        for (const IncidenceEntry* e = compiled.preBegin(t); e != compiled.preEnd(t); ++e)
+            inArcs[t].push_back({e->place, e->weight});
+        for (const IncidenceEntry* e = compiled.postBegin(t); e != compiled.postEnd(t); ++e)
+            outArcs[t].push_back({e->place, e->weight});
     }
 }
 
@@ -212,39 +357,110 @@ bool visitedHas(const vector<Marking>& visited, const Marking& M) {
 }
 
 
-//=======================================  BFS  ==============================================================
-vector<Marking> BFS(const PetriNet& net) {
-    vector<vector<pair<int,int>>> inArcs, outArcs;
-    buildTables(net, inArcs, outArcs);
+//======================================= Hashed state store =================================================
+int MarkingStore::find(const Marking& M) const {
+    if ((int)M.tokens.size() != width()) return -1;
+    return FlatStateStore<int>::find(M.tokens.data());
+}
 
-    Marking M0;
-    for (auto& p : net.places)
-        M0.tokens.push_back(p.initialMarking);
+Marking MarkingStore::at(int i) const {
+    Marking M;
+    M.tokens.assign(tokensOf(i), tokensOf(i) + width());
+    return M;
+}
+
+vector<Marking> MarkingStore::toVector() const {
+    vector<Marking> result(size());
+    for (int i = 0; i < size(); i++)
+        result[i] = at(i);
+    return result;
+}
 
-    vector<Marking> visited;
-    vector<Marking> q;
-    int head = 0;
 
-    visited.push_back(M0);
-    q.push_back(M0);
+//=======================================  BFS  ==============================================================
+vector<Marking> BFS(const PetriNet& net) {
+    CompiledNet compiled(net);
+    return BFS(compiled);
+}
 
-    while (head < (int)q.size()) {
-        Marking curr = q[head];
+/*
+ * BFS với Model (IntModel / PackedModel, explicitModels.h). Trả về false nếu Model báo firing
+ * không hợp lệ (PackedModel gặp mạng không 1-safe), result khi đó không dùng được.
+ *
+ * Tập transition enabled được tính tăng dần: mỗi state trong hàng đợi mang theo bitset enabled
+ * của nó. Khi M' = fire(M, t), bitset của M' chép từ M rồi chỉ kiểm tra lại affected(t)
+ * (consumer của các place mà t chạm tới), thay vì kiểm tra lại cả T transition.
+ */
+template <typename Model>
+static bool exploreBFS(const CompiledNet& compiled, const Model& model, vector<Marking>& result) {
+    typedef typename Model::Word Word;
+    int W = model.width();
+    int T = model.numTransitions();
+    int EW = (T + 63) / 64; //số word của 1 bitset enabled
+
+    vector<Word> curr(W), next(W);
+    model.initial(curr.data());
+
+    //store giữ state theo đúng thứ tự được khám phá, nên chính nó là hàng đợi BFS (head chạy dọc store);
+    //enabledQueue song song với phần [head, size) của store
+    FlatStateStore<Word> visited(W);
+    visited.insert(curr.data());
+    vector<uint64_t> enabledQueue(EW, 0);
+    size_t enabledHead = 0;
+    for (int t = 0; t < T; t++)
+        if (model.isEnabled(curr.data(), t)) enabledQueue[t / 64] |= 1ULL << (t % 64);
+
+    vector<uint64_t> currEnabled(EW), nextEnabled(EW);
+    int head = 0;
+    while (head < visited.size()) {
+        copy(visited.stateOf(head), visited.stateOf(head) + W, curr.begin());
+        copy(enabledQueue.begin() + enabledHead, enabledQueue.begin() + enabledHead + EW, currEnabled.begin());
         head++;
+        enabledHead += EW;
+        //bỏ phần đầu đã duyệt khi nó chiếm quá nửa bộ đệm
+        if (enabledHead > (1u << 16) && enabledHead * 2 > enabledQueue.size()) {
+            enabledQueue.erase(enabledQueue.begin(), enabledQueue.begin() + enabledHead);
+            enabledHead = 0;
+        }
 
-        for (int t = 0; t < (int)net.transitions.size(); t++) {
-            if (isEnabled(curr, t, inArcs)) {
-                Marking M2 = fire(curr, t, inArcs, outArcs);
+        for (int w = 0; w < EW; w++) {
+            for (uint64_t bits = currEnabled[w]; bits; bits &= bits - 1) {
+                int t = w * 64 + __builtin_ctzll(bits);
+                if (!model.fire(curr.data(), next.data(), t)) return false;
+                if (!visited.insert(next.data()).second) continue;
 
-                if (!visitedHas(visited, M2)) {
-                    visited.push_back(M2);
-                    q.push_back(M2);
+                nextEnabled = currEnabled;
+                for (const int* u = compiled.affectedBegin(t); u != compiled.affectedEnd(t); ++u) {
+                    if (model.isEnabled(next.data(), *u)) nextEnabled[*u / 64] |= 1ULL << (*u % 64);
+                    else nextEnabled[*u / 64] &= ~(1ULL << (*u % 64));
                 }
+                enabledQueue.insert(enabledQueue.end(), nextEnabled.begin(), nextEnabled.end());
             }
         }
     }
 
-    return visited;
+    result.assign(visited.size(), Marking());
+    for (int i = 0; i < visited.size(); i++)
+        model.decode(visited.stateOf(i), result[i]);
+    return true;
+}
+
+bool packedBFS(const CompiledNet& net, vector<Marking>& result) {
+    return PackedNet::isSafeCandidate(net) && exploreBFS(net, PackedModel(net), result);
+}
+
+vector<Marking> intBFS(const CompiledNet& net) {
+    vector<Marking> result;
+    exploreBFS(net, IntModel(net), result);
+    return result;
+}
+
+vector<Marking> BFS(const CompiledNet& net) {
+    //mạng có dạng 1-safe (trọng số 1, M0 <= 1): thử engine bit-packed trước, nếu mạng hóa ra
+    //không safe thì chạy lại bằng vector<int>. Thứ tự khám phá của 2 engine giống nhau.
+    vector<Marking> result;
+    if (packedBFS(net, result)) return result;
+    return intBFS(net);
 }
 
 
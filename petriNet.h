@@ -5,6 +5,8 @@
 #include <vector>
 #include <sstream>
 #include <stdexcept>
+#include <unordered_map>
+#include "stateStore.h"
 #include "tinyxml2.h" //thư viện ngoài, dùng để parse file pnml
 using namespace tinyxml2; //namespace 
 using namespace std; //namespace
@@ -26,13 +28,38 @@ struct Arc {
     int weight = 1;
 };
 
+struct PetriNet;
+
+/*
+ * Bảng ký hiệu: id của place/transition -> chỉ số trong places/transitions, tra bằng băm O(1)
+ * thay cho findPlace()/findTransition() (quét tuyến tính). Mỗi id được lưu đúng 1 lần làm khóa;
+ * place và transition có dãy chỉ số riêng. Id trùng: giữ phần tử đầu tiên, như findPlace().
+ */
+class SymbolTable {
+public:
+    void build(const PetriNet& net);
+    int place(const string& id) const;      //-1 nếu không có
+    int transition(const string& id) const; //-1 nếu không có
+    //bảng còn khớp với net: cùng số place/transition và id tại mọi chỉ số đã lưu không đổi
+    //(phát hiện cả id bị sửa hay đổi chỗ sau build()); O(P + T) phép tra bảng băm
+    bool covers(const PetriNet& net) const;
+
+private:
+    unordered_map<string, int> placeIndex, transitionIndex;
+    size_t numPlaces = 0, numTransitions = 0;
+};
+
 //PetriNet, 3 attrs: places, transitions, arcs
 struct PetriNet {
     vector<Place> places; //mảng động chứa các Place, 1 attr PetriNet
     vector<Transition> transitions; //mảng động chứa Transition, 1 attr PetriNet
     vector<Arc> arcs;//mảng động chứa các đường nối (Place -> Transition) + (Transition -> Place), 1 attr PetriNet
+    SymbolTable symbols; //điền bởi loadPNML()/loadPNMLStream(); mạng dựng tay thì dùng symbolsOf()
 };
 
+//net.symbols nếu còn khớp với net, ngược lại dựng bảng vào scratch rồi trả về scratch
+const SymbolTable& symbolsOf(const PetriNet& net, SymbolTable& scratch);
+
 struct Marking {
     vector<int> tokens;
     bool operator==(const Marking& other) const {
@@ -40,10 +67,39 @@ struct Marking {
     }
 };
 
+//tập marking đã thăm: bảng băm open-addressing (stateStore.h), mỗi marking chỉ lưu đúng 1 lần,
+//chỉ số marking theo thứ tự chèn
+class MarkingStore : public FlatStateStore<int> {
+public:
+    explicit MarkingStore(int numPlaces) : FlatStateStore<int>(numPlaces) {}
+    //chèn M nếu chưa có. Trả về {chỉ số state, true nếu vừa chèn mới}
+    pair<int, bool> insert(const Marking& M) { return FlatStateStore<int>::insert(M.tokens.data()); }
+    //chỉ số của M trong store, -1 nếu chưa thăm
+    int find(const Marking& M) const;
+    bool contains(const Marking& M) const { return find(M) != -1; }
+    //con trỏ tới token của state thứ i (bị vô hiệu khi store lớn lên)
+    const int* tokensOf(int i) const { return stateOf(i); }
+    Marking at(int i) const;
+    vector<Marking> toVector() const;
+};
+
+//các phần tử con trực tiếp của 1 <page> PNML (hoặc của <net>), trước khi gộp
+struct PnmlPage {
+    vector<Place> places;
+    vector<Transition> transitions;
+    vector<Arc> arcs;
+    vector<pair<string, string>> referencePlaces;      //id của referencePlace -> ref
+    vector<pair<string, string>> referenceTransitions; //id của referenceTransition -> ref
+};
+
+class CompiledNet; //compiledNet.h
+
 //các hàm có thể dùng, implemented ở petriNet.cpp
 int findPlace(const vector<Place>& places, const string& id);
 int findTransition(const vector<Transition>& transitions, const string& id);
 PetriNet loadPNML(const string& filename);
+//gộp các page (thứ tự tài liệu) thành 1 mạng: cung nối reference node được nối thẳng tới node thật
+PetriNet mergePnmlPages(vector<PnmlPage> pages);
 void verify(const PetriNet& net);
 void printPetriNetInfo(const PetriNet& net);
 
@@ -53,5 +109,9 @@ bool isEnabled(const Marking& M, int t, const vector<vector<pair<int,int>>>& inA
 Marking fire(const Marking& M, int t, const vector<vector<pair<int,int>>>& inArcs, const vector<vector<pair<int,int>>>& outArcs);
 bool visitedHas(const vector<Marking>& visited, const Marking& M);
 vector<Marking> BFS(const PetriNet& net);
+vector<Marking> BFS(const CompiledNet& net);
+//2 engine mà BFS() chọn: packedBFS() trả về false nếu mạng không 1-safe (result khi đó không dùng được)
+bool packedBFS(const CompiledNet& net, vector<Marking>& result);
+vector<Marking> intBFS(const CompiledNet& net);
 void printMarking(const Marking& M);
 #endif // PETRINET_H
\ No newline at end of file
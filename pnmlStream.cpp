@@ -0,0 +1,422 @@
+#include "pnmlStream.h"
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <zlib.h>
+
+namespace {
+
+const char* const FORMAT_ERROR = "Cannot open PNML file or XML format error!";
+
+/*
+ * Pull parser XML tối giản: mỗi lần next() trả về một sự kiện (mở thẻ, đóng thẻ, đoạn text).
+ * Bỏ qua khai báo <?...?>, comment, <!DOCTYPE ...>; CDATA là một đoạn text riêng. Giải mã
+ * entity chuẩn và &#...; trong text lẫn thuộc tính, "\r\n" -> "\n" như tinyxml2.
+ * Thẻ rỗng <a/> sinh cả StartElement lẫn EndElement. Thẻ đóng phải khớp thẻ mở gần nhất.
+ */
+class XmlPullParser {
+public:
+    enum Event { StartElement, EndElement, Text, EndDocument };
+
+    explicit XmlPullParser(const ChunkReader& read) : read(read), buffer(1 << 16) {}
+
+    Event next() {
+        if (pendingEnd) {
+            pendingEnd = false;
+            tagName = openTags.back();
+            openTags.pop_back();
+            return EndElement;
+        }
+        while (true) {
+            int c = peek();
+            if (c == EOF) {
+                if (!openTags.empty()) fail();
+                return EndDocument;
+            }
+            if (c != '<') {
+                readText();
+                return Text;
+            }
+            get();
+            c = peek();
+            if (c == '?') {
+                skipPast("?>");
+            } else if (c == '!') {
+                get();
+                if (accept("--")) skipPast("-->");
+                else if (accept("[CDATA[")) {
+                    readUntil("]]>");
+                    return Text;
+                } else skipDeclaration();
+            } else if (c == '/') {
+                get();
+                readName(tagName);
+                skipSpace();
+                if (get() != '>' || openTags.empty() || openTags.back() != tagName) fail();
+                openTags.pop_back();
+                return EndElement;
+            } else {
+                readStartTag();
+                return StartElement;
+            }
+        }
+    }
+
+    const string& name() const { return tagName; }
+    const string& text() const { return textValue; }
+    int depth() const { return openTags.size(); } //sau StartElement: tính cả thẻ vừa mở
+    const char* attribute(const char* key) const {
+        for (const auto& a : attributes)
+            if (a.first == key) return a.second.c_str();
+        return nullptr;
+    }
+
+    [[noreturn]] static void fail() { throw runtime_error(FORMAT_ERROR); }
+
+private:
+    ChunkReader read;
+    vector<char> buffer;
+    size_t pos = 0, end = 0;
+    bool eof = false;
+    bool pendingEnd = false;
+    vector<string> openTags;
+    string tagName;
+    string textValue;
+    vector<pair<string, string>> attributes;
+
+    int peek() {
+        if (pos == end) {
+            if (eof) return EOF;
+            end = read(buffer.data(), buffer.size());
+            pos = 0;
+            if (end == 0) {
+                eof = true;
+                return EOF;
+            }
+        }
+        return (unsigned char)buffer[pos];
+    }
+    int get() {
+        int c = peek();
+        if (c != EOF) pos++;
+        return c;
+    }
+    int getOrFail() {
+        int c = get();
+        if (c == EOF) fail();
+        return c;
+    }
+    //đọc tiếp literal nếu khớp; literal chỉ dùng sau '<!', khớp một phần nghĩa là XML hỏng
+    bool accept(const char* literal) {
+        if (peek() != literal[0]) return false;
+        for (const char* s = literal; *s; s++)
+            if (getOrFail() != *s) fail();
+        return true;
+    }
+    void skipSpace() {
+        while (isspace(peek())) get();
+    }
+    static bool isNameChar(int c) {
+        return c != EOF && !isspace(c) && !strchr("<>/=\"'!?", c);
+    }
+    void readName(string& out) {
+        out.clear();
+        while (isNameChar(peek())) out += (char)get();
+        if (out.empty()) fail();
+    }
+    //bỏ qua tới hết terminator
+    void skipPast(const char* terminator) {
+        size_t n = strlen(terminator), matched = 0;
+        while (matched < n) {
+            int c = getOrFail();
+            matched = c == terminator[matched] ? matched + 1 : (c == terminator[0] ? 1 : 0);
+        }
+    }
+    //text thô (CDATA) tới terminator, vào textValue
+    void readUntil(const char* terminator) {
+        size_t n = strlen(terminator);
+        textValue.clear();
+        while (textValue.size() < n || textValue.compare(textValue.size() - n, n, terminator) != 0)
+            textValue += (char)getOrFail();
+        textValue.resize(textValue.size() - n);
+    }
+    //<!DOCTYPE ...> có thể chứa [ ... ] lồng nhau
+    void skipDeclaration() {
+        int brackets = 0;
+        while (true) {
+            int c = getOrFail();
+            if (c == '[') brackets++;
+            else if (c == ']') brackets--;
+            else if (c == '>' && brackets <= 0) return;
+        }
+    }
+    void appendCodePoint(string& out, unsigned long cp) {
+        if (cp < 0x80) out += (char)cp;
+        else if (cp < 0x800) {
+            out += (char)(0xC0 | (cp >> 6));
+            out += (char)(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += (char)(0xE0 | (cp >> 12));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        } else {
+            out += (char)(0xF0 | (cp >> 18));
+            out += (char)(0x80 | ((cp >> 12) & 0x3F));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        }
+    }
+    //sau '&': giải mã entity; entity lạ giữ nguyên dạng thô như tinyxml2
+    void readEntity(string& out) {
+        string entity;
+        while (peek() != ';' && peek() != EOF && peek() != '<' && entity.size() < 16) entity += (char)get();
+        if (peek() != ';') {
+            out += '&';
+            out += entity;
+            return;
+        }
+        get();
+        if (entity == "lt") out += '<';
+        else if (entity == "gt") out += '>';
+        else if (entity == "amp") out += '&';
+        else if (entity == "quot") out += '"';
+        else if (entity == "apos") out += '\'';
+        else if (entity.size() > 1 && entity[0] == '#') {
+            bool hex = entity[1] == 'x' || entity[1] == 'X';
+            char* endPtr = nullptr;
+            unsigned long cp = strtoul(entity.c_str() + (hex ? 2 : 1), &endPtr, hex ? 16 : 10);
+            if (*endPtr) fail();
+            appendCodePoint(out, cp);
+        } else {
+            out += '&';
+            out += entity;
+            out += ';';
+        }
+    }
+    void appendChar(string& out, int c) {
+        if (c == '&') readEntity(out);
+        else if (c == '\r') {
+            out += '\n';
+            if (peek() == '\n') get();
+        } else out += (char)c;
+    }
+    void readText() {
+        textValue.clear();
+        while (peek() != '<' && peek() != EOF) appendChar(textValue, get());
+    }
+    void readStartTag() {
+        readName(tagName);
+        attributes.clear();
+        while (true) {
+            skipSpace();
+            int c = getOrFail();
+            if (c == '>') break;
+            if (c == '/') {
+                if (getOrFail() != '>') fail();
+                pendingEnd = true;
+                break;
+            }
+            pos--; //c là ký tự đầu của tên thuộc tính, vẫn còn trong buffer
+            pair<string, string> attr;
+            readName(attr.first);
+            skipSpace();
+            if (getOrFail() != '=') fail();
+            skipSpace();
+            int quote = getOrFail();
+            if (quote != '"' && quote != '\'') fail();
+            for (int ch = getOrFail(); ch != quote; ch = getOrFail()) appendChar(attr.second, ch);
+            attributes.push_back(std::move(attr));
+        }
+        openTags.push_back(tagName);
+    }
+};
+
+bool isBlank(const string& s) {
+    for (char c : s)
+        if (!isspace((unsigned char)c)) return false;
+    return true;
+}
+
+/*
+ * Dựng PetriNet từ luồng sự kiện: 1 <pnml>, 2 <net> đầu tiên, rồi các container lồng nhau
+ * (net và mọi <page> bên trong nó, page có thể lồng page). Mỗi container có một PnmlPage riêng
+ * theo thứ tự mở thẻ (giống collectPages() của loadPNML()); phần tử là con trực tiếp của
+ * container trên đỉnh ngăn xếp. Hết tài liệu thì gộp bằng mergePnmlPages().
+ * Trong một place/transition, <name>/<initialMarking> và <text> đầu tiên của chúng
+ * được theo dõi bằng độ sâu; giá trị là node con đầu tiên của <text> nếu đó là text (GetText()).
+ */
+class PnmlBuilder {
+public:
+    PetriNet build(XmlPullParser& parser) {
+        while (true) {
+            XmlPullParser::Event event = parser.next();
+            if (event == XmlPullParser::EndDocument) break;
+            int depth = parser.depth();
+            if (event == XmlPullParser::StartElement) onStart(parser, depth);
+            else if (event == XmlPullParser::EndElement) onEnd(depth + 1);
+            else onText(parser.text(), depth);
+        }
+        if (!sawPnml) throw runtime_error("Invalid PNML: missing <pnml>");
+        if (!sawNet) throw runtime_error("Invalid PNML: missing <net>");
+        return mergePnmlPages(std::move(pages));
+    }
+
+private:
+    enum Item { None, PlaceItem, TransitionItem, ArcItem };
+    enum Field { NoField, NameField, MarkingField };
+
+    bool sawRoot = false, sawPnml = false, sawNet = false;
+    vector<PnmlPage> pages;
+    vector<pair<int, int>> containers; //(độ sâu, chỉ số trong pages) của net/page đang mở
+
+    Item item = None;
+    PnmlPage* target = nullptr;
+    int itemDepth = 0;
+    Place place;
+    Transition trans;
+    bool nameSeen = false, markingSeen = false;
+
+    Field field = NoField;
+    int fieldDepth = 0;     //độ sâu của <name>/<initialMarking> đang đọc
+    bool textSeen = false;  //đã gặp <text> đầu tiên của field
+    int textDepth = 0;      //độ sâu của <text> đó, 0 nếu không ở trong nó
+    bool firstChildSeen = false;
+    bool hasValue = false;
+    string value;
+
+    void onStart(XmlPullParser& parser, int depth) {
+        const string& name = parser.name();
+        if (depth == 1) {
+            if (!sawRoot && name == "pnml") sawPnml = true;
+            sawRoot = true;
+            return;
+        }
+        if (!sawPnml) return;
+        if (textDepth && depth > textDepth) firstChildSeen = true;
+        if (depth == 2 && name == "net" && !sawNet) {
+            sawNet = true;
+            openContainer(depth);
+            return;
+        }
+        if (!containers.empty() && depth == containers.back().first + 1 && item == None) {
+            if (name == "page") openContainer(depth);
+            else beginItem(parser, name, depth, pages[containers.back().second]);
+            return;
+        }
+        if (item == PlaceItem || item == TransitionItem) {
+            if (depth == itemDepth + 1 && field == NoField) {
+                if (name == "name" && !nameSeen) {
+                    nameSeen = true;
+                    beginField(NameField, depth);
+                } else if (name == "initialMarking" && item == PlaceItem && !markingSeen) {
+                    markingSeen = true;
+                    beginField(MarkingField, depth);
+                }
+            } else if (field != NoField && depth == fieldDepth + 1 && name == "text" && !textSeen) {
+                textSeen = true;
+                textDepth = depth;
+                firstChildSeen = false;
+            }
+        }
+    }
+
+    void onEnd(int depth) {
+        if (textDepth == depth) textDepth = 0;
+        if (field != NoField && depth == fieldDepth) endField();
+        if (item != None && depth == itemDepth) endItem();
+        if (!containers.empty() && depth == containers.back().first) containers.pop_back();
+    }
+
+    void openContainer(int depth) {
+        containers.push_back({depth, (int)pages.size()});
+        pages.emplace_back();
+    }
+
+    void onText(const string& text, int depth) {
+        if (!textDepth || depth != textDepth || firstChildSeen || isBlank(text)) return;
+        firstChildSeen = true;
+        hasValue = true;
+        value = text;
+    }
+
+    void beginItem(XmlPullParser& parser, const string& name, int depth, PnmlPage& page) {
+        target = &page;
+        itemDepth = depth;
+        nameSeen = markingSeen = false;
+        if (name == "place" && parser.attribute("id")) {
+            item = PlaceItem;
+            place = Place();
+            place.id = parser.attribute("id");
+        } else if (name == "transition" && parser.attribute("id")) {
+            item = TransitionItem;
+            trans = Transition();
+            trans.id = parser.attribute("id");
+        } else if (name == "arc") {
+            Arc arc;
+            if (const char* id = parser.attribute("id")) arc.id = id;
+            if (const char* src = parser.attribute("source")) arc.source = src;
+            if (const char* tgt = parser.attribute("target")) arc.target = tgt;
+            if (!arc.source.empty() && !arc.target.empty()) target->arcs.push_back(arc);
+            item = ArcItem; //bỏ qua nội dung bên trong (inscription, graphics...)
+        } else if ((name == "referencePlace" || name == "referenceTransition") && parser.attribute("id") &&
+                   parser.attribute("ref")) {
+            auto& refs = name == "referencePlace" ? target->referencePlaces : target->referenceTransitions;
+            refs.push_back({parser.attribute("id"), parser.attribute("ref")});
+            item = ArcItem;
+        } else {
+            item = ArcItem; //phần tử khác: chỉ bỏ qua cây con
+        }
+    }
+
+    void endItem() {
+        if (item == PlaceItem) target->places.push_back(place);
+        else if (item == TransitionItem) target->transitions.push_back(trans);
+        item = None;
+    }
+
+    void beginField(Field f, int depth) {
+        field = f;
+        fieldDepth = depth;
+        textSeen = false;
+        hasValue = false;
+    }
+
+    void endField() {
+        if (hasValue) {
+            string& name = item == PlaceItem ? place.name : trans.name;
+            if (field == NameField) name = value;
+            else {
+                try {
+                    place.initialMarking = stoi(value);
+                } catch (...) { place.initialMarking = 0; }
+            }
+        }
+        field = NoField;
+    }
+};
+
+}
+
+PetriNet loadPNMLStream(const ChunkReader& read) {
+    XmlPullParser parser(read);
+    PnmlBuilder builder;
+    return builder.build(parser);
+}
+
+PetriNet loadPNMLStream(const string& filename) {
+    //gzread giải nén từng khối vào buffer của parser; file không nén được đọc thẳng (transparent)
+    unique_ptr<gzFile_s, int (*)(gzFile)> file(gzopen(filename.c_str(), "rb"), gzclose);
+    if (!file) throw runtime_error(FORMAT_ERROR);
+    gzbuffer(file.get(), 1 << 17);
+    return loadPNMLStream([&](char* buffer, size_t size) {
+        int got = gzread(file.get(), buffer, size);
+        if (got < 0) throw runtime_error(FORMAT_ERROR); //gzip hỏng hoặc bị cắt cụt
+        return (size_t)got;
+    });
+}
+
+bool isGzipFile(const string& filename) {
+    unique_ptr<FILE, int (*)(FILE*)> file(fopen(filename.c_str(), "rb"), fclose);
+    unsigned char magic[2];
+    return file && fread(magic, 1, 2, file.get()) == 2 && magic[0] == 0x1f && magic[1] == 0x8b;
+}
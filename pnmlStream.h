@@ -0,0 +1,31 @@
+#ifndef PNML_STREAM_H
+#define PNML_STREAM_H
+
+#include "petriNet.h"
+#include <functional>
+
+//nguồn dữ liệu cho loader: ghi tối đa size byte vào buffer, trả về số byte đã ghi (0 = hết dữ liệu)
+typedef function<size_t(char* buffer, size_t size)> ChunkReader;
+
+/*
+ * Loader PNML dạng streaming (pull parser), thay cho loadPNML() với file rất lớn.
+ *
+ * Đọc file theo từng khối cố định và điền PetriNet trong đúng 1 lượt, không dựng DOM:
+ * bộ nhớ ngoài PetriNet kết quả chỉ gồm buffer đọc, ngăn xếp tên thẻ đang mở và phần tử
+ * place/transition/arc đang đọc dở.
+ *
+ * Cùng ngữ nghĩa với loadPNML(): <pnml> -> <net> đầu tiên -> mọi <page> (kể cả page lồng nhau)
+ * gộp thành 1 mạng, reference place/transition được nối tới node thật; tên và initialMarking
+ * lấy từ <text> đầu tiên; arc thiếu source/target bị bỏ. Cùng thông báo lỗi. Page được đọc
+ * tuần tự trong lượt đọc duy nhất (loadPNML() thì đọc song song trên DOM).
+ *
+ * Bản đọc file nhận cả file nén gzip (.pnml.gz): giải nén từng khối ngay trong lượt đọc,
+ * không cần file tạm và không bao giờ giữ cả tài liệu đã giải nén trong bộ nhớ.
+ */
+PetriNet loadPNMLStream(const string& filename);
+PetriNet loadPNMLStream(const ChunkReader& read);
+
+//file bắt đầu bằng magic gzip (1f 8b)
+bool isGzipFile(const string& filename);
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef STATE_STORE_H
+#define STATE_STORE_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <algorithm>
+
+//fingerprint 64-bit của một state gồm n word (int token hoặc uint64_t bit-packed)
+template <typename Word>
+inline uint64_t hashState(const Word* state, int n) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ (uint64_t)n;
+    for (int i = 0; i < n; i++) {
+        h ^= (uint64_t)state[i];
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 32;
+    }
+    //finalizer (splitmix64) để bit thấp, dùng làm chỉ số slot, phân bố đều
+    h ^= h >> 30; h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27; h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+/*
+ * Bảng băm open-addressing lưu các state có độ rộng cố định (width word / state), mỗi state đúng 1 lần.
+ * Word của mọi state nằm liền nhau trong một mảng phẳng (không cấp phát heap riêng cho từng state),
+ * bảng slot chỉ giữ chỉ số state, tra cứu/chèn O(1) trung bình nhờ fingerprint 64-bit.
+ * State được đánh chỉ số theo thứ tự chèn.
+ */
+template <typename Word>
+class FlatStateStore {
+public:
+    explicit FlatStateStore(int width) : stateWidth(width) {
+        slots.assign(1024, 0);
+        mask = slots.size() - 1;
+    }
+
+    //chèn state nếu chưa có. Trả về {chỉ số state, true nếu vừa chèn mới}
+    std::pair<int, bool> insert(const Word* state) {
+        uint64_t fp = hashState(state, stateWidth);
+        size_t pos = probe(state, fp);
+        if (slots[pos] != 0) return {slots[pos] - 1, false};
+
+        int idx = size();
+        pool.insert(pool.end(), state, state + stateWidth);
+        fingerprints.push_back(fp);
+        slots[pos] = idx + 1;
+        //giữ load factor <= 0.5 để chuỗi dò ngắn
+        if ((size_t)size() * 2 > slots.size()) grow();
+        return {idx, true};
+    }
+
+    //chỉ số của state, -1 nếu chưa có
+    int find(const Word* state) const {
+        return slots[probe(state, hashState(state, stateWidth))] - 1;
+    }
+
+    int size() const { return (int)fingerprints.size(); }
+    int width() const { return stateWidth; }
+    //con trỏ tới state thứ i (bị vô hiệu khi store lớn lên)
+    const Word* stateOf(int i) const { return &pool[(size_t)i * stateWidth]; }
+    size_t memoryBytes() const {
+        return pool.capacity() * sizeof(Word) + fingerprints.capacity() * sizeof(uint64_t)
+             + slots.capacity() * sizeof(int);
+    }
+
+private:
+    int stateWidth;
+    std::vector<Word> pool;             //state i chiếm [i*width, (i+1)*width)
+    std::vector<uint64_t> fingerprints; //fingerprint của từng state, dùng để so nhanh và rehash
+    std::vector<int> slots;             //linear probing, lưu chỉ số state + 1, 0 = trống
+    uint64_t mask;
+
+    //vị trí slot chứa state, hoặc slot trống đầu tiên gặp khi dò tuyến tính
+    size_t probe(const Word* state, uint64_t fp) const {
+        size_t pos = fp & mask;
+        while (true) {
+            int entry = slots[pos];
+            if (entry == 0) return pos;
+            int idx = entry - 1;
+            if (fingerprints[idx] == fp &&
+                std::equal(state, state + stateWidth, pool.begin() + (size_t)idx * stateWidth))
+                return pos;
+            pos = (pos + 1) & mask;
+        }
+    }
+
+    void grow() {
+        slots.assign(slots.size() * 2, 0);
+        mask = slots.size() - 1;
+        for (int i = 0; i < size(); i++) {
+            size_t pos = fingerprints[i] & mask;
+            while (slots[pos] != 0) pos = (pos + 1) & mask;
+            slots[pos] = i + 1;
+        }
+    }
+};
+
+#endif
@@ -1,8 +1,16 @@
 #include "symbolicPetriNet.h"
+#include "stateStore.h"
+#include "invariants.h"
+#include <climits>
 #include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <stdexcept>
 
-SymbolicPetriNet::SymbolicPetriNet(const PetriNet& petriNet){
-    this->net = petriNet;
+SymbolicPetriNet::SymbolicPetriNet(const PetriNet& petriNet, const SymbolicOptions& options)
+    : net(petriNet), compiled(petriNet), options(options) {
     this->BDD_ops = nullptr;
     this->initialState = nullptr;
     this->reachableStates = nullptr;
@@ -14,49 +22,258 @@ SymbolicPetriNet::~SymbolicPetriNet() {
     if (BDD_ops) {
         if (initialState) Cudd_RecursiveDeref(BDD_ops, initialState);
         if (reachableStates) Cudd_RecursiveDeref(BDD_ops, reachableStates);
-        for (DdNode* relation : transitionRelations) {
-            Cudd_RecursiveDeref(BDD_ops, relation);
+        for (LocalRelation& rel : transitionRelations) {
+            Cudd_RecursiveDeref(BDD_ops, rel.relation);
+            Cudd_RecursiveDeref(BDD_ops, rel.currentCube);
+        }
+        for (ImpliedPlace& implied : impliedPlaces) {
+            if (implied.sum) Cudd_RecursiveDeref(BDD_ops, implied.sum);
         }
         Cudd_Quit(BDD_ops);
     }
 }
 
 void SymbolicPetriNet::initialize() {
-    int numVars = 2 * numPlaces;
+    safeEncoding = options.tokenBound == 1;
+    computePlaceBounds();
+    selectImpliedPlaces();
+
+    // Map places to variables. Places are laid out in placeOrder; inside a place the
+    // bits go least significant first and each bit is an adjacent x/x' pair, so a
+    // transition relation only spans the levels of its own places.
+    // Implied places get no variables at all.
+    placeOrder = computePlaceOrder(compiled, options.order);
+    placeToCurrentVars.assign(numPlaces, {});
+    placeToNextVars.assign(numPlaces, {});
+    int numVars = 0;
+    for (int k = 0; k < numPlaces; k++) {
+        int p = placeOrder[k];
+        if (impliedIndex[p] >= 0) continue;
+        int bits = 1;
+        while ((1LL << bits) - 1 < placeBound[p]) bits++;
+        for (int b = 0; b < bits; b++) {
+            placeToCurrentVars[p].push_back(numVars++);
+            placeToNextVars[p].push_back(numVars++);
+        }
+    }
+    numCurrentVars = numVars / 2;
+
     BDD_ops = Cudd_Init(numVars, 0, CUDD_UNIQUE_SLOTS, CUDD_CACHE_SLOTS, 0);
     
     if (!BDD_ops) {
         throw std::runtime_error("Failed to initialize CUDD");
     }
     
-    std::cout << "\n[Task 3] Initialized BDD with " << numVars << " variables" << std::endl;
-    
-    // Map places to variables
-    for (int i = 0; i < numPlaces; i++) {
-        placeToCurrentVar[net.places[i].id] = i;
-        placeToNextVar[net.places[i].id] = i + numPlaces;
+    std::cout << "\n[Task 3] Initialized BDD with " << numVars << " variables ("
+              << variableOrderName(options.order) << " place order, interleaved x/x', "
+              << (safeEncoding ? std::string("1-safe encoding")
+                               : "binary token counts, bound " + std::to_string(*std::max_element(placeBound.begin(), placeBound.end())))
+              << ")" << std::endl;
+    if (!impliedPlaces.empty()) {
+        std::cout << "[Task 3] " << impliedPlaces.size() << " of " << numPlaces
+                  << " places implied by P-invariants, encoded without variables" << std::endl;
     }
+
+    // Σ y_q·M(q) of every implied place as an ADD over the current variables
+    for (ImpliedPlace& implied : impliedPlaces) {
+        implied.sum = weightedSum(implied.others);
+    }
+
+    // Keep every current/next pair adjacent and in x, x' order while reordering:
+    // renaming by Cudd_bddPermute then only swaps neighbouring levels.
+    // The bits of one place form a group as well, so a counter is never split.
+    for (int p = 0; p < numPlaces; p++) {
+        if (placeToCurrentVars[p].empty()) continue;
+        int first = placeToCurrentVars[p].front();
+        int width = 2 * placeToCurrentVars[p].size();
+        if (width > 2) Cudd_MakeTreeNode(BDD_ops, first, width, MTR_DEFAULT);
+        for (int v : placeToCurrentVars[p]) {
+            Cudd_MakeTreeNode(BDD_ops, v, 2, MTR_FIXED);
+        }
+    }
+    if (options.reordering != CUDD_REORDER_NONE) {
+        Cudd_AutodynEnable(BDD_ops, options.reordering);
+        std::cout << "[Task 3] Dynamic reordering enabled (" << reorderingName(options.reordering) << ")" << std::endl;
+    }
+}
+
+/*
+ * Token bound of every place.
+ *  - tokenBound == 1 or k > 1: the given bound for all places.
+ *  - tokenBound == 0: structural bound. A place covered by a P-invariant y is bounded by
+ *    floor(y·M0 / y_p). Other places: if no transition produces more tokens than it
+ *    consumes (sum of output weights <= sum of input weights), the total token count
+ *    never grows, so the place is bounded by the initial token total.
+ */
+void SymbolicPetriNet::computePlaceBounds() {
+    placeBound.assign(numPlaces, options.tokenBound);
+    if (options.tokenBound == 0) {
+        vector<long long> invBound = invariantBounds(compiled, computePInvariants(compiled).invariants);
+        bool conservative = true;
+        for (int t = 0; t < numTransitions && conservative; t++) {
+            long long balance = 0;
+            for (const IncidenceEntry* e = compiled.preBegin(t); e != compiled.preEnd(t); ++e) balance -= e->weight;
+            for (const IncidenceEntry* e = compiled.postBegin(t); e != compiled.postEnd(t); ++e) balance += e->weight;
+            if (balance > 0) conservative = false;
+        }
+        long long total = 0;
+        for (int v : compiled.initialMarking()) total += v;
+        for (int p = 0; p < numPlaces; p++) {
+            long long bound = invBound[p];
+            if (conservative && (bound < 0 || total < bound)) bound = total;
+            if (bound < 0) {
+                throw std::runtime_error("Cannot derive a structural token bound for place " + net.places[p].id +
+                                         " (not covered by a P-invariant, net is not conservative); "
+                                         "set SymbolicOptions::tokenBound explicitly");
+            }
+            if (bound > INT_MAX) {
+                throw std::runtime_error("Structural token bound of place " + net.places[p].id + " does not fit in int");
+            }
+            placeBound[p] = (int)std::max(1LL, bound);
+        }
+    } else if (options.tokenBound < 0) {
+        throw std::runtime_error("SymbolicOptions::tokenBound must be >= 0");
+    }
+    if (!safeEncoding) {
+        for (int p = 0; p < numPlaces; p++) {
+            if (compiled.initialMarking()[p] > placeBound[p]) {
+                throw std::runtime_error("Initial marking of place " + net.places[p].id + " exceeds the token bound");
+            }
+        }
+    }
+}
+
+/*
+ * Places whose token count need not be stored (options.eliminateImpliedPlaces).
+ * For a P-invariant y with y·M = y·M0 =: total and a place p in its support,
+ *   M(p) = (total - Σ_{q != p} y_q·M(q)) / y_p,
+ * so p can be dropped as long as every other place of y keeps its variables.
+ * Invariants are taken greedily: one place per invariant, chosen among the places
+ * no earlier choice depends on (largest bound first, it frees the most bits).
+ * Invariants already touching an eliminated place are skipped.
+ *
+ * Only done when the encoding is exact for every reachable marking: each place needs a
+ * P-invariant bound within its placeBound (structural bounds of tokenBound = 0 are proven
+ * already), and the 1-safe encoding also needs unit weights, i.e. a proven 1-safe net.
+ * Otherwise the encoding merges or cuts firings, the invariants do not hold in it and
+ * eliminating a place would change the state space.
+ */
+void SymbolicPetriNet::selectImpliedPlaces() {
+    impliedPlaces.clear();
+    impliedIndex.assign(numPlaces, -1);
+    if (!options.eliminateImpliedPlaces) return;
+
+    if (safeEncoding && !hasUnitSafeStructure()) {
+        std::cout << "[Task 3] Implied places not eliminated: the 1-safe encoding needs unit weights and M0 <= 1"
+                  << std::endl;
+        return;
+    }
+
+    InvariantResult pInvariants = computePInvariants(compiled);
+    if (options.tokenBound != 0) {
+        vector<long long> bounds = invariantBounds(compiled, pInvariants.invariants);
+        for (int p = 0; p < numPlaces; p++) {
+            if (bounds[p] < 0 || bounds[p] > placeBound[p]) {
+                std::cout << "[Task 3] Implied places not eliminated: place " << net.places[p].id
+                          << " is not proven to stay within its token bound " << placeBound[p] << std::endl;
+                return;
+            }
+        }
+    }
+    vector<char> referenced(numPlaces, 0); //place occurs in the invariant of an eliminated place
+    for (const Invariant& inv : pInvariants.invariants) {
+        if (inv.entries.size() < 2) continue; //a constant place: nothing else carries its value
+        int chosen = -1;
+        bool usable = true;
+        for (const auto& entry : inv.entries) {
+            int p = entry.first;
+            if (impliedIndex[p] >= 0) usable = false;
+            if (!referenced[p] && (chosen < 0 || placeBound[p] > placeBound[chosen])) chosen = p;
+        }
+        if (!usable || chosen < 0) continue;
+
+        ImpliedPlace implied;
+        implied.place = chosen;
+        implied.total = 0;
+        implied.sum = nullptr;
+        for (const auto& [p, y] : inv.entries) {
+            implied.total += y * compiled.initialMarking()[p];
+            referenced[p] = 1;
+            if (p == chosen) implied.weight = y;
+            else implied.others.push_back({p, y});
+        }
+        impliedIndex[chosen] = impliedPlaces.size();
+        impliedPlaces.push_back(implied);
+    }
+}
+
+//M(place) of an implied place from the token counts of the other places of its invariant; -1 if not integral
+long long SymbolicPetriNet::impliedValue(int place, const vector<int>& marking) const {
+    const ImpliedPlace& implied = impliedPlaces[impliedIndex[place]];
+    long long rest = implied.total;
+    for (const auto& [q, y] : implied.others) rest -= y * marking[q];
+    if (rest < 0 || rest % implied.weight != 0) return -1;
+    return rest / implied.weight;
+}
+
+// ADD of Σ y_q·M(q) over the current variables, M(q) = Σ 2^b·x_q,b; every q must have variables (referenced)
+DdNode* SymbolicPetriNet::weightedSum(const vector<pair<int, long long>>& terms) {
+    DdNode* sum = Cudd_addConst(BDD_ops, 0);
+    Cudd_Ref(sum);
+    for (const auto& [q, y] : terms) {
+        for (size_t b = 0; b < placeToCurrentVars[q].size(); b++) {
+            DdNode* var = Cudd_addIthVar(BDD_ops, placeToCurrentVars[q][b]);
+            Cudd_Ref(var);
+            DdNode* coefficient = Cudd_addConst(BDD_ops, (CUDD_VALUE_TYPE)(y << b));
+            Cudd_Ref(coefficient);
+            DdNode* term = Cudd_addApply(BDD_ops, Cudd_addTimes, var, coefficient);
+            Cudd_Ref(term);
+            Cudd_RecursiveDeref(BDD_ops, var);
+            Cudd_RecursiveDeref(BDD_ops, coefficient);
+            DdNode* temp = Cudd_addApply(BDD_ops, Cudd_addPlus, sum, term);
+            Cudd_Ref(temp);
+            Cudd_RecursiveDeref(BDD_ops, sum);
+            Cudd_RecursiveDeref(BDD_ops, term);
+            sum = temp;
+        }
+    }
+    return sum;
+}
+
+// markings where low <= M(place) <= high for an implied place, over the current variables (referenced)
+DdNode* SymbolicPetriNet::impliedRange(int place, long long low, long long high) {
+    const ImpliedPlace& implied = impliedPlaces[impliedIndex[place]];
+    // low <= (total - S) / w <= high  <=>  total - high·w <= S <= total - low·w
+    double lower = high == LLONG_MAX ? -1.0 : (double)(implied.total - high * implied.weight);
+    double upper = (double)(implied.total - low * implied.weight);
+    DdNode* range = upper < lower ? Cudd_ReadLogicZero(BDD_ops)
+                                  : Cudd_addBddInterval(BDD_ops, implied.sum, lower, upper);
+    Cudd_Ref(range);
+    return range;
+}
+
+// "M(place) >= value" for any place, implied or not (referenced)
+DdNode* SymbolicPetriNet::placeAtLeast(int place, long long value) {
+    if (impliedIndex[place] >= 0) return impliedRange(place, value, LLONG_MAX);
+    return bddAtLeast(placeToCurrentVars[place], value);
 }
 
 void SymbolicPetriNet::encodeInitialMarking() {
+    // 1-safe: any count above zero is "marked"
+    vector<int> m0 = compiled.initialMarking();
+    if (safeEncoding) {
+        for (int& v : m0) v = v > 0 ? 1 : 0;
+    }
+
     initialState = Cudd_ReadOne(BDD_ops);
     Cudd_Ref(initialState);
-
     for (int i = 0; i < numPlaces; i++) {
-        std::string pId = net.places[i].id;
-        int varIdx = placeToCurrentVar[pId];
-        DdNode* var = Cudd_bddIthVar(BDD_ops, varIdx);
-        DdNode* temp;
-
-        // If place has a token (1-safe), AND with var. Else AND with NOT var.
-        if (net.places[i].initialMarking > 0) {
-            temp = Cudd_bddAnd(BDD_ops, initialState, var);
-        } else {
-            temp = Cudd_bddAnd(BDD_ops, initialState, Cudd_Not(var));
-        }
-        
+        if (impliedIndex[i] >= 0) continue;
+        DdNode* value = bddValue(placeToCurrentVars[i], m0[i]);
+        DdNode* temp = Cudd_bddAnd(BDD_ops, initialState, value);
         Cudd_Ref(temp);
         Cudd_RecursiveDeref(BDD_ops, initialState);
+        Cudd_RecursiveDeref(BDD_ops, value);
         initialState = temp;
     }
     
@@ -64,16 +281,126 @@ void SymbolicPetriNet::encodeInitialMarking() {
 }
 
 void SymbolicPetriNet::buildTransitionRelations() {
+    // relations persisted by an earlier run on the same net and encoding
+    if (options.cacheRelations && !options.cacheDirectory.empty()) {
+        std::string file = cacheFile("rel");
+        DdNode** roots = nullptr;
+        int loaded = 0;
+        if (std::filesystem::exists(file)) {
+            loaded = Dddmp_cuddBddArrayLoad(BDD_ops, DDDMP_ROOT_MATCHLIST, nullptr, DDDMP_VAR_MATCHIDS,
+                                            nullptr, nullptr, nullptr, DDDMP_MODE_BINARY, &file[0], nullptr, &roots);
+        }
+        if (loaded == numTransitions) {
+            for (int t = 0; t < numTransitions; t++) {
+                transitionRelations.push_back(getTransitionRelation(t, roots[t]));
+            }
+            free(roots);
+            cout << "[Task 3] Loaded " << transitionRelations.size() << " transition relations from " << file << endl;
+            return;
+        }
+        for (int i = 0; i < loaded; i++) Cudd_RecursiveDeref(BDD_ops, roots[i]);
+        free(roots);
+    }
+
     std::cout << "[Task 3] Building transition relations..." << std::endl;
     for(int t=0;t<numTransitions;t++){
-        DdNode * relation = getTransitionRelation(t);
-        transitionRelations.push_back(relation);
-        Cudd_Ref(relation);
+        transitionRelations.push_back(getTransitionRelation(t));
     }
     cout<< "[Task 3] Built " <<transitionRelations.size()<<" transition relations"<<endl;
 }
 
-DdNode* SymbolicPetriNet::getTransitionRelation(int transIdx) {
+/*
+ * Canonical key of the encoded net: structure (pre/post incidence, initial marking),
+ * token bounds and the variable layout chosen by initialize(). Two runs with the same
+ * key build identical BDD variables, so BDDs stored by one can be loaded by the other.
+ */
+std::string SymbolicPetriNet::cacheKey() const {
+    vector<long long> words = {1 /* format version */, numPlaces, numTransitions, safeEncoding};
+    for (int p = 0; p < numPlaces; p++) {
+        words.push_back(compiled.initialMarking()[p]);
+        words.push_back(placeBound[p]);
+        words.insert(words.end(), placeToCurrentVars[p].begin(), placeToCurrentVars[p].end());
+        words.insert(words.end(), placeToNextVars[p].begin(), placeToNextVars[p].end());
+    }
+    for (const ImpliedPlace& implied : impliedPlaces) {
+        words.push_back(-3);
+        words.push_back(implied.place);
+        words.push_back(implied.weight);
+        words.push_back(implied.total);
+        for (const auto& [q, y] : implied.others) {
+            words.push_back(q);
+            words.push_back(y);
+        }
+    }
+    for (int t = 0; t < numTransitions; t++) {
+        words.push_back(-1);
+        for (const IncidenceEntry* e = compiled.preBegin(t); e != compiled.preEnd(t); ++e) {
+            words.push_back(e->place);
+            words.push_back(e->weight);
+        }
+        words.push_back(-2);
+        for (const IncidenceEntry* e = compiled.postBegin(t); e != compiled.postEnd(t); ++e) {
+            words.push_back(e->place);
+            words.push_back(e->weight);
+        }
+    }
+    char key[17];
+    snprintf(key, sizeof(key), "%016llx", (unsigned long long)hashState(words.data(), (int)words.size()));
+    return key;
+}
+
+std::string SymbolicPetriNet::cacheFile(const char* kind) const {
+    return (std::filesystem::path(options.cacheDirectory) / (cacheKey() + "." + kind + ".bdd")).string();
+}
+
+/*
+ * Load reachableStates stored by an earlier run (dddmp binary format).
+ * Returns false when caching is off or no file matches cacheKey(); the caller then
+ * runs computeReachability() as usual.
+ */
+bool SymbolicPetriNet::loadReachableStates() {
+    if (options.cacheDirectory.empty()) return false;
+    std::string file = cacheFile("reach");
+    if (!std::filesystem::exists(file)) return false;
+
+    DdNode* loaded = Dddmp_cuddBddLoad(BDD_ops, DDDMP_VAR_MATCHIDS, nullptr, nullptr, nullptr,
+                                       DDDMP_MODE_BINARY, &file[0], nullptr);
+    if (!loaded) {
+        std::cout << "[Task 3] Could not read " << file << ", recomputing" << std::endl;
+        return false;
+    }
+    if (reachableStates) Cudd_RecursiveDeref(BDD_ops, reachableStates);
+    reachableStates = loaded; // already referenced by dddmp
+    std::cout << "[Task 3] Loaded reachable states from " << file << std::endl;
+    return true;
+}
+
+//write reachableStates (and the transition relations if options.cacheRelations) to options.cacheDirectory
+void SymbolicPetriNet::storeReachableStates() {
+    if (options.cacheDirectory.empty() || !reachableStates) return;
+    std::filesystem::create_directories(options.cacheDirectory);
+
+    std::string name = cacheKey();
+    std::string file = cacheFile("reach");
+    if (Dddmp_cuddBddStore(BDD_ops, &name[0], reachableStates, nullptr, nullptr, DDDMP_MODE_BINARY,
+                           DDDMP_VARIDS, &file[0], nullptr) != DDDMP_SUCCESS) {
+        throw std::runtime_error("Failed to store reachable states to " + file);
+    }
+    std::cout << "[Task 3] Stored reachable states to " << file << std::endl;
+
+    if (options.cacheRelations && (int)transitionRelations.size() == numTransitions) {
+        vector<DdNode*> roots;
+        for (const LocalRelation& rel : transitionRelations) roots.push_back(rel.relation);
+        std::string relFile = cacheFile("rel");
+        if (Dddmp_cuddBddArrayStore(BDD_ops, &name[0], numTransitions, roots.data(), nullptr, nullptr, nullptr,
+                                    DDDMP_MODE_BINARY, DDDMP_VARIDS, &relFile[0], nullptr) != DDDMP_SUCCESS) {
+            throw std::runtime_error("Failed to store transition relations to " + relFile);
+        }
+        std::cout << "[Task 3] Stored transition relations to " << relFile << std::endl;
+    }
+}
+
+SymbolicPetriNet::LocalRelation SymbolicPetriNet::getTransitionRelation(int transIdx, DdNode* storedRelation) {
     /*
      * What is a Transition Relation?
      * 
@@ -91,66 +418,205 @@ DdNode* SymbolicPetriNet::getTransitionRelation(int transIdx) {
      * Example: p1 ---> t1 ---> p2
      *   Current state: p1=1, p2=0
      *   Next state:    p1=0, p2=1
+     *
+     * Only the places touched by t appear in the relation. Places outside
+     * pre(t) ∪ post(t) are neither quantified nor renamed by the image, so
+     * they pass through unchanged without any x <-> x' frame constraint.
+     *
+     * An implied place has no variables: its next value follows from the
+     * invariant, only the guard "consumed <= M(p) <= bound - produced + consumed"
+     * is added, as a condition on the current variables of its invariant.
+     *
+     * storedRelation: relation loaded from the cache (referenced, ownership is taken);
+     * only the quantification cube and renaming vectors are rebuilt then.
      */
     
-    std::string transId = net.transitions[transIdx].id;
-    std::set<std::string> inputPlaces; 
-    std::set<std::string> outputPlaces; 
-    
-    for (const auto& arc : net.arcs) {
-        if (arc.target == transId) {
-            inputPlaces.insert(arc.source);
-        }
-        if (arc.source == transId) {
-            outputPlaces.insert(arc.target);
-        }
+    std::vector<int> consumed(numPlaces, 0), produced(numPlaces, 0);
+    std::vector<int> touched;
+    for (const IncidenceEntry* e = compiled.preBegin(transIdx); e != compiled.preEnd(transIdx); ++e) {
+        if (!consumed[e->place] && !produced[e->place]) touched.push_back(e->place);
+        consumed[e->place] += e->weight;
     }
-    
-    DdNode* relation = Cudd_ReadOne(BDD_ops);
-    Cudd_Ref(relation);
-    
-    for (const auto& placeId : inputPlaces) {
-        int currentVar = placeToCurrentVar[placeId];
-        DdNode* var = Cudd_bddIthVar(BDD_ops, currentVar);
-        DdNode* temp = Cudd_bddAnd(BDD_ops, relation, var);
-        Cudd_Ref(temp);
-        Cudd_RecursiveDeref(BDD_ops, relation);
-        relation = temp;
+    for (const IncidenceEntry* e = compiled.postBegin(transIdx); e != compiled.postEnd(transIdx); ++e) {
+        if (!consumed[e->place] && !produced[e->place]) touched.push_back(e->place);
+        produced[e->place] += e->weight;
     }
     
-    for (int i = 0; i < numPlaces; i++) {
-        std::string placeId = net.places[i].id;
-        int currentVar = placeToCurrentVar[placeId];
-        int nextVar = placeToNextVar[placeId];
-        
-        bool isInput = inputPlaces.count(placeId) > 0;
-        bool isOutput = outputPlaces.count(placeId) > 0;
+    LocalRelation rel;
+    rel.relation = storedRelation ? storedRelation : Cudd_ReadOne(BDD_ops);
+    if (!storedRelation) Cudd_Ref(rel.relation);
+    rel.currentCube = Cudd_ReadOne(BDD_ops);
+    Cudd_Ref(rel.currentCube);
+    
+    for (int p : touched) {
+        DdNode* temp;
+        if (!storedRelation) {
+            DdNode* effect = impliedIndex[p] >= 0
+                ? impliedRange(p, consumed[p], (long long)placeBound[p] - produced[p] + consumed[p])
+                : tokenEffect(p, consumed[p], produced[p]);
+            temp = Cudd_bddAnd(BDD_ops, rel.relation, effect);
+            Cudd_Ref(temp);
+            Cudd_RecursiveDeref(BDD_ops, rel.relation);
+            Cudd_RecursiveDeref(BDD_ops, effect);
+            rel.relation = temp;
+        }
         
-        DdNode* currentVarNode = Cudd_bddIthVar(BDD_ops, currentVar);
-        DdNode* nextVarNode = Cudd_bddIthVar(BDD_ops, nextVar);
+        for (size_t b = 0; b < placeToCurrentVars[p].size(); b++) {
+            DdNode* currentVarNode = Cudd_bddIthVar(BDD_ops, placeToCurrentVars[p][b]);
+            temp = Cudd_bddAnd(BDD_ops, rel.currentCube, currentVarNode);
+            Cudd_Ref(temp);
+            Cudd_RecursiveDeref(BDD_ops, rel.currentCube);
+            rel.currentCube = temp;
+            
+            rel.currentVars.push_back(currentVarNode);
+            rel.nextVars.push_back(Cudd_bddIthVar(BDD_ops, placeToNextVars[p][b]));
+        }
+    }
+    return rel;
+}
+
+/*
+ * Effect of a transition on one touched place, as a referenced BDD over the
+ * place's current and next variables.
+ *  - 1-safe encoding: input requires x, then x' = 0 unless the place is also an
+ *    output; output sets x' = 1 (weights are ignored, as in the original model).
+ *    With implied places, an output-only place must also be empty (¬x), otherwise
+ *    the merged token would break the invariants they are computed from.
+ *  - binary encoding: x >= consumed  and  x' = x - consumed + produced  and  x' <= bound.
+ */
+DdNode* SymbolicPetriNet::tokenEffect(int place, int consumed, int produced) {
+    const vector<int>& x = placeToCurrentVars[place];
+    const vector<int>& y = placeToNextVars[place];
+
+    if (safeEncoding) {
+        DdNode* currentVarNode = Cudd_bddIthVar(BDD_ops, x[0]);
+        DdNode* nextVarNode = Cudd_bddIthVar(BDD_ops, y[0]);
         DdNode* effect;
-        
-        if (isInput && isOutput) {
-            effect = Cudd_bddXnor(BDD_ops, currentVarNode, nextVarNode);
-        } else if (isInput && !isOutput) {
-            effect = Cudd_Not(nextVarNode);
-        } else if (!isInput && isOutput) {
-            effect = nextVarNode;
+        if (consumed && produced) {
+            effect = Cudd_bddAnd(BDD_ops, currentVarNode, nextVarNode);
+        } else if (consumed) {
+            effect = Cudd_bddAnd(BDD_ops, currentVarNode, Cudd_Not(nextVarNode));
+        } else if (!impliedPlaces.empty()) {
+            effect = Cudd_bddAnd(BDD_ops, Cudd_Not(currentVarNode), nextVarNode);
         } else {
-            effect = Cudd_bddXnor(BDD_ops, currentVarNode, nextVarNode);
+            effect = nextVarNode;
         }
         Cudd_Ref(effect);
-        DdNode* temp = Cudd_bddAnd(BDD_ops, relation, effect);
+        return effect;
+    }
+
+    // x' = x + delta  (for delta < 0 written as x = x' + |delta|, so x >= |delta| comes for free)
+    long long delta = (long long)produced - consumed;
+    DdNode* effect = delta >= 0 ? bddAddConstant(x, y, delta) : bddAddConstant(y, x, -delta);
+
+    DdNode* enabled = bddAtLeast(x, consumed);
+    DdNode* tooMany = bddAtLeast(y, (long long)placeBound[place] + 1);
+    DdNode* guard = Cudd_bddAnd(BDD_ops, enabled, Cudd_Not(tooMany));
+    Cudd_Ref(guard);
+    Cudd_RecursiveDeref(BDD_ops, enabled);
+    Cudd_RecursiveDeref(BDD_ops, tooMany);
+
+    DdNode* temp = Cudd_bddAnd(BDD_ops, effect, guard);
+    Cudd_Ref(temp);
+    Cudd_RecursiveDeref(BDD_ops, effect);
+    Cudd_RecursiveDeref(BDD_ops, guard);
+    return temp;
+}
+
+// minterm "vars == value" (LSB first); value outside the representable range gives 0
+DdNode* SymbolicPetriNet::bddValue(const vector<int>& vars, long long value) {
+    if (value < 0 || (vars.size() < 63 && value >= (1LL << vars.size()))) {
+        DdNode* zero = Cudd_ReadLogicZero(BDD_ops);
+        Cudd_Ref(zero);
+        return zero;
+    }
+    DdNode* result = Cudd_ReadOne(BDD_ops);
+    Cudd_Ref(result);
+    for (int b = (int)vars.size() - 1; b >= 0; b--) {
+        DdNode* var = Cudd_bddIthVar(BDD_ops, vars[b]);
+        DdNode* temp = Cudd_bddAnd(BDD_ops, result, ((value >> b) & 1) ? var : Cudd_Not(var));
+        Cudd_Ref(temp);
+        Cudd_RecursiveDeref(BDD_ops, result);
+        result = temp;
+    }
+    return result;
+}
+
+// comparator "vars >= value", built from the least significant bit up:
+// x[0..b] >= c[0..b]  <=>  x_b > c_b, or x_b == c_b and x[0..b-1] >= c[0..b-1]
+DdNode* SymbolicPetriNet::bddAtLeast(const vector<int>& vars, long long value) {
+    if (value <= 0 || (vars.size() < 63 && value >= (1LL << vars.size()))) {
+        DdNode* constant = value <= 0 ? Cudd_ReadOne(BDD_ops) : Cudd_ReadLogicZero(BDD_ops);
+        Cudd_Ref(constant);
+        return constant;
+    }
+    DdNode* result = Cudd_ReadOne(BDD_ops);
+    Cudd_Ref(result);
+    for (size_t b = 0; b < vars.size(); b++) {
+        DdNode* var = Cudd_bddIthVar(BDD_ops, vars[b]);
+        DdNode* temp = ((value >> b) & 1) ? Cudd_bddAnd(BDD_ops, var, result)
+                                          : Cudd_bddOr(BDD_ops, var, result);
+        Cudd_Ref(temp);
+        Cudd_RecursiveDeref(BDD_ops, result);
+        result = temp;
+    }
+    return result;
+}
+
+// ripple-carry adder relation "y == x + delta" (delta >= 0) with no overflow out of the top bit
+DdNode* SymbolicPetriNet::bddAddConstant(const vector<int>& x, const vector<int>& y, long long delta) {
+    DdNode* relation = Cudd_ReadOne(BDD_ops);
+    Cudd_Ref(relation);
+    DdNode* carry = Cudd_ReadLogicZero(BDD_ops);
+    Cudd_Ref(carry);
+
+    for (size_t b = 0; b < x.size(); b++) {
+        DdNode* xb = Cudd_bddIthVar(BDD_ops, x[b]);
+        DdNode* yb = Cudd_bddIthVar(BDD_ops, y[b]);
+        bool db = (delta >> b) & 1;
+
+        // sum = x_b xor d_b xor carry, carry' = majority(x_b, d_b, carry)
+        DdNode* sum = Cudd_bddXor(BDD_ops, xb, carry);
+        Cudd_Ref(sum);
+        if (db) sum = Cudd_Not(sum);
+        DdNode* nextCarry = db ? Cudd_bddOr(BDD_ops, xb, carry) : Cudd_bddAnd(BDD_ops, xb, carry);
+        Cudd_Ref(nextCarry);
+
+        DdNode* bit = Cudd_bddXnor(BDD_ops, yb, sum);
+        Cudd_Ref(bit);
+        DdNode* temp = Cudd_bddAnd(BDD_ops, relation, bit);
         Cudd_Ref(temp);
         Cudd_RecursiveDeref(BDD_ops, relation);
-        Cudd_RecursiveDeref(BDD_ops, effect);
+        Cudd_RecursiveDeref(BDD_ops, bit);
+        Cudd_RecursiveDeref(BDD_ops, sum);
+        Cudd_RecursiveDeref(BDD_ops, carry);
         relation = temp;
+        carry = nextCarry;
     }
-    return relation;
+
+    // no carry out, and no bits of delta above the counter width
+    bool deltaFits = x.size() >= 63 || (delta >> x.size()) == 0;
+    DdNode* temp = deltaFits ? Cudd_bddAnd(BDD_ops, relation, Cudd_Not(carry)) : Cudd_ReadLogicZero(BDD_ops);
+    Cudd_Ref(temp);
+    Cudd_RecursiveDeref(BDD_ops, relation);
+    Cudd_RecursiveDeref(BDD_ops, carry);
+    return temp;
 }
 
 
 void SymbolicPetriNet::computeReachability() {
+    if (reachableStates) {
+        Cudd_RecursiveDeref(BDD_ops, reachableStates);
+        reachableStates = nullptr;
+    }
+    switch (options.strategy) {
+        case ReachabilityStrategy::FullImage: computeReachabilityFullImage(); break;
+        case ReachabilityStrategy::Frontier: computeReachabilityFrontier(); break;
+        case ReachabilityStrategy::Chaining: computeReachabilityChaining(); break;
+    }
+}
+
+void SymbolicPetriNet::computeReachabilityFullImage() {
     std::cout << "[Task 3] Computing reachability..." << std::endl;
     
     reachableStates = initialState;
@@ -162,7 +628,6 @@ void SymbolicPetriNet::computeReachability() {
         iteration++;
         
         DdNode* newStates = imageComputation(reachableStates);
-        Cudd_Ref(newStates);
         
         DdNode* novel = Cudd_bddAnd(BDD_ops, newStates, Cudd_Not(reachableStates));
         Cudd_Ref(novel);
@@ -191,43 +656,240 @@ void SymbolicPetriNet::computeReachability() {
     }
 }
 
-DdNode* SymbolicPetriNet::imageComputation(DdNode* states) {
-    // TODO: Implement
-    DdNode * result = Cudd_ReadLogicZero(BDD_ops);
-    Cudd_Ref(result);
+/*
+ * Frontier iteration: only the states found in the previous iteration are
+ * imaged, and the novelty test is the frontier itself (image minus reached).
+ */
+void SymbolicPetriNet::computeReachabilityFrontier() {
+    std::cout << "[Task 3] Computing reachability (frontier)..." << std::endl;
+
+    reachableStates = initialState;
+    Cudd_Ref(reachableStates);
+    DdNode* frontier = initialState;
+    Cudd_Ref(frontier);
+
+    int iteration = 0;
+    while (frontier != Cudd_ReadLogicZero(BDD_ops)) {
+        iteration++;
+        DdNode* img = imageComputation(frontier);
+        Cudd_RecursiveDeref(BDD_ops, frontier);
+
+        frontier = Cudd_bddAnd(BDD_ops, img, Cudd_Not(reachableStates));
+        Cudd_Ref(frontier);
+        Cudd_RecursiveDeref(BDD_ops, img);
 
-    for (const auto& transRel : transitionRelations) {
-        DdNode* temp = Cudd_bddAnd(BDD_ops, states, transRel);
+        DdNode* temp = Cudd_bddOr(BDD_ops, reachableStates, frontier);
         Cudd_Ref(temp);
-        
-        for (int i = 0; i < numPlaces; i++) {
-            int currentVar = placeToCurrentVar[net.places[i].id];
-            DdNode* cube = Cudd_bddIthVar(BDD_ops, currentVar);
-            DdNode* temp2 = Cudd_bddExistAbstract(BDD_ops, temp, cube);
-            Cudd_Ref(temp2);
-            Cudd_RecursiveDeref(BDD_ops, temp);
-            temp = temp2;
+        Cudd_RecursiveDeref(BDD_ops, reachableStates);
+        reachableStates = temp;
+    }
+    Cudd_RecursiveDeref(BDD_ops, frontier);
+
+    std::cout << "[Task 3] Fixed point reached at iteration " << iteration << std::endl;
+}
+
+/*
+ * Chaining: within one iteration transitions are applied one after another
+ * in chainingOrder(), and states produced by a transition are already imaged
+ * by the transitions after it. The next iteration starts from everything
+ * added during this one.
+ */
+void SymbolicPetriNet::computeReachabilityChaining() {
+    std::cout << "[Task 3] Computing reachability (chaining)..." << std::endl;
+
+    vector<int> order = chainingOrder();
+    reachableStates = initialState;
+    Cudd_Ref(reachableStates);
+    DdNode* frontier = initialState;
+    Cudd_Ref(frontier);
+
+    int iteration = 0;
+    while (frontier != Cudd_ReadLogicZero(BDD_ops)) {
+        iteration++;
+        DdNode* iterationStart = reachableStates;
+        Cudd_Ref(iterationStart);
+
+        for (int t : order) {
+            DdNode* img = imageOf(t, frontier);
+            DdNode* novel = Cudd_bddAnd(BDD_ops, img, Cudd_Not(reachableStates));
+            Cudd_Ref(novel);
+            Cudd_RecursiveDeref(BDD_ops, img);
+            if (novel != Cudd_ReadLogicZero(BDD_ops)) {
+                DdNode* temp = Cudd_bddOr(BDD_ops, reachableStates, novel);
+                Cudd_Ref(temp);
+                Cudd_RecursiveDeref(BDD_ops, reachableStates);
+                reachableStates = temp;
+
+                temp = Cudd_bddOr(BDD_ops, frontier, novel);
+                Cudd_Ref(temp);
+                Cudd_RecursiveDeref(BDD_ops, frontier);
+                frontier = temp;
+            }
+            Cudd_RecursiveDeref(BDD_ops, novel);
         }
-        
-        int* permutation = new int[2 * numPlaces];
-        for (int i = 0; i < 2 * numPlaces; i++) {
-            permutation[i] = i; 
+
+        Cudd_RecursiveDeref(BDD_ops, frontier);
+        frontier = Cudd_bddAnd(BDD_ops, reachableStates, Cudd_Not(iterationStart));
+        Cudd_Ref(frontier);
+        Cudd_RecursiveDeref(BDD_ops, iterationStart);
+    }
+    Cudd_RecursiveDeref(BDD_ops, frontier);
+
+    std::cout << "[Task 3] Fixed point reached at iteration " << iteration << std::endl;
+}
+
+/*
+ * Transition order for chaining, following the token flow: a breadth-first
+ * walk from the initially marked places. A transition is ordered when one of
+ * its input places is reached, and its output places are visited next.
+ * Transitions never reached (e.g. without input places) are appended.
+ */
+vector<int> SymbolicPetriNet::chainingOrder() const {
+    vector<int> order;
+    vector<bool> placeSeen(numPlaces, false), transSeen(numTransitions, false);
+    vector<int> queue;
+    for (int p = 0; p < numPlaces; p++) {
+        if (compiled.initialMarking()[p] > 0) {
+            placeSeen[p] = true;
+            queue.push_back(p);
+        }
+    }
+    for (size_t head = 0; head < queue.size(); head++) {
+        int p = queue[head];
+        for (const int* t = compiled.consumersBegin(p); t != compiled.consumersEnd(p); ++t) {
+            if (transSeen[*t]) continue;
+            transSeen[*t] = true;
+            order.push_back(*t);
+            for (const IncidenceEntry* e = compiled.postBegin(*t); e != compiled.postEnd(*t); ++e) {
+                if (!placeSeen[e->place]) {
+                    placeSeen[e->place] = true;
+                    queue.push_back(e->place);
+                }
+            }
         }
+    }
+    for (int t = 0; t < numTransitions; t++) {
+        if (!transSeen[t]) order.push_back(t);
+    }
+    return order;
+}
 
-        for (int i = 0; i < numPlaces; i++) {
-            std::string placeId = net.places[i].id;
-            int currentVar = placeToCurrentVar[placeId];
-            int nextVar = placeToNextVar[placeId];
-            
-            permutation[currentVar] = nextVar;
-            permutation[nextVar] = currentVar;
+/*
+ * Saturation-ordered reachability.
+ *
+ * Transitions are grouped by their top variable: the highest BDD level among
+ * the places they touch. Groups are processed bottom-up. Group i is fired to a
+ * fixed point, and after every batch of new states the groups below it are
+ * saturated again. When group i is done, the set is closed under groups 0..i.
+ * This is the Ciardo-style saturation order applied to whole BDD sets. Local
+ * events near the bottom of the order are exhausted before any event above
+ * them fires, which keeps intermediate BDDs small on asynchronous nets. There
+ * is no iteration cap.
+ */
+void SymbolicPetriNet::computeReachabilitySaturation() {
+    std::cout << "[Task 3] Computing reachability (saturation)..." << std::endl;
+
+    // top level of a transition = smallest level among its touched current variables
+    // (and, with implied places, the variables its guards read)
+    std::map<int, vector<int>> byTopLevel;
+    for (int t = 0; t < numTransitions; t++) {
+        int top = Cudd_ReadSize(BDD_ops);
+        for (DdNode* var : transitionRelations[t].currentVars) {
+            top = std::min(top, Cudd_ReadPerm(BDD_ops, Cudd_NodeReadIndex(var)));
         }
-        
-        DdNode* renamed = Cudd_bddPermute(BDD_ops, temp, permutation);
-        Cudd_Ref(renamed);
-        delete[] permutation;
-        Cudd_RecursiveDeref(BDD_ops, temp);
-        
+        if (!impliedPlaces.empty()) {
+            int* support = nullptr;
+            int size = Cudd_SupportIndices(BDD_ops, transitionRelations[t].relation, &support);
+            for (int i = 0; i < size; i++) top = std::min(top, Cudd_ReadPerm(BDD_ops, support[i]));
+            free(support);
+        }
+        byTopLevel[top].push_back(t);
+    }
+    // groups[0] is the bottom-most group
+    vector<vector<int>> groups;
+    for (auto it = byTopLevel.rbegin(); it != byTopLevel.rend(); ++it) {
+        groups.push_back(it->second);
+    }
+
+    if (reachableStates) Cudd_RecursiveDeref(BDD_ops, reachableStates);
+    Cudd_Ref(initialState);
+    long long images = 0;
+    reachableStates = groups.empty() ? initialState
+                                     : saturate(initialState, (int)groups.size() - 1, groups, images);
+
+    std::cout << "[Task 3] Saturation finished: " << groups.size() << " transition groups, "
+              << images << " group images" << std::endl;
+}
+
+// union of the images of every transition in the group, referenced
+DdNode* SymbolicPetriNet::groupImage(const vector<int>& group, DdNode* states) {
+    DdNode* result = Cudd_ReadLogicZero(BDD_ops);
+    Cudd_Ref(result);
+    for (int t : group) {
+        DdNode* img = imageOf(t, states);
+        DdNode* temp = Cudd_bddOr(BDD_ops, result, img);
+        Cudd_Ref(temp);
+        Cudd_RecursiveDeref(BDD_ops, result);
+        Cudd_RecursiveDeref(BDD_ops, img);
+        result = temp;
+    }
+    return result;
+}
+
+// closes states (consumed reference) under groups 0..groupIdx, returns a referenced BDD
+DdNode* SymbolicPetriNet::saturate(DdNode* states, int groupIdx, const vector<vector<int>>& groups, long long& images) {
+    DdNode* S = groupIdx > 0 ? saturate(states, groupIdx - 1, groups, images) : states;
+    DdNode* frontier = S;
+    Cudd_Ref(frontier);
+
+    while (true) {
+        DdNode* img = groupImage(groups[groupIdx], frontier);
+        images++;
+        Cudd_RecursiveDeref(BDD_ops, frontier);
+
+        DdNode* novel = Cudd_bddAnd(BDD_ops, img, Cudd_Not(S));
+        Cudd_Ref(novel);
+        Cudd_RecursiveDeref(BDD_ops, img);
+        if (novel == Cudd_ReadLogicZero(BDD_ops)) {
+            Cudd_RecursiveDeref(BDD_ops, novel);
+            return S;
+        }
+
+        DdNode* grown = Cudd_bddOr(BDD_ops, S, novel);
+        Cudd_Ref(grown);
+        Cudd_RecursiveDeref(BDD_ops, novel);
+        if (groupIdx > 0) grown = saturate(grown, groupIdx - 1, groups, images);
+
+        // only states added since the last image of this group need to be imaged again
+        frontier = Cudd_bddAnd(BDD_ops, grown, Cudd_Not(S));
+        Cudd_Ref(frontier);
+        Cudd_RecursiveDeref(BDD_ops, S);
+        S = grown;
+    }
+}
+
+/*
+ * Image of states under one transition: relational product
+ *   ∃x_touched. states ∧ R_t   (one fused Cudd_bddAndAbstract call)
+ * followed by renaming x'_touched -> x_touched. Returns a referenced BDD.
+ */
+DdNode* SymbolicPetriNet::imageOf(int transIdx, DdNode* states) {
+    LocalRelation& rel = transitionRelations[transIdx];
+    DdNode* product = Cudd_bddAndAbstract(BDD_ops, states, rel.relation, rel.currentCube);
+    Cudd_Ref(product);
+    DdNode* renamed = Cudd_bddSwapVariables(BDD_ops, product, rel.nextVars.data(),
+                                            rel.currentVars.data(), (int)rel.nextVars.size());
+    Cudd_Ref(renamed);
+    Cudd_RecursiveDeref(BDD_ops, product);
+    return renamed;
+}
+
+DdNode* SymbolicPetriNet::imageComputation(DdNode* states) {
+    DdNode * result = Cudd_ReadLogicZero(BDD_ops);
+    Cudd_Ref(result);
+
+    for (int t = 0; t < numTransitions; t++) {
+        DdNode* renamed = imageOf(t, states);
         DdNode* newResult = Cudd_bddOr(BDD_ops, result, renamed);
         Cudd_Ref(newResult);
         Cudd_RecursiveDeref(BDD_ops, result);
@@ -242,46 +904,87 @@ void SymbolicPetriNet::printResults() {
     std::cout << "\n========== TASK 3: SYMBOLIC REACHABILITY ==========" << std::endl;
     std::cout << "Number of places: " << numPlaces << std::endl;
     std::cout << "Number of transitions: " << numTransitions << std::endl;
+    if (!impliedPlaces.empty()) {
+        std::cout << "Implied places (no BDD variables):";
+        for (const ImpliedPlace& implied : impliedPlaces) std::cout << " " << net.places[implied.place].id;
+        std::cout << std::endl;
+    }
     
     // Count reachable states
-    double stateCount = Cudd_CountMinterm(BDD_ops, reachableStates, numPlaces);
+    double stateCount = Cudd_CountMinterm(BDD_ops, reachableStates, numCurrentVars);
     std::cout << "Number of reachable states: " << stateCount << std::endl;
+    std::cout << "BDD nodes (reachable set): " << Cudd_DagSize(reachableStates) << std::endl;
+    printReorderingStats();
     
     std::cout << "===================================================" << std::endl;
 }
 
+void SymbolicPetriNet::printReorderingStats() {
+    std::cout << "Reordering method: " << reorderingName(options.reordering) << std::endl;
+    std::cout << "Reorderings performed: " << Cudd_ReadReorderings(BDD_ops)
+              << " (" << Cudd_ReadReorderingTime(BDD_ops) << " ms)" << std::endl;
+    std::cout << "Live nodes: " << Cudd_ReadNodeCount(BDD_ops)
+              << " | Peak nodes: " << Cudd_ReadPeakNodeCount(BDD_ops) << std::endl;
+}
+
+const char* reorderingName(Cudd_ReorderingType method) {
+    switch (method) {
+        case CUDD_REORDER_NONE: return "none";
+        case CUDD_REORDER_SAME: return "same";
+        case CUDD_REORDER_RANDOM: return "random";
+        case CUDD_REORDER_RANDOM_PIVOT: return "random pivot";
+        case CUDD_REORDER_SIFT: return "sifting";
+        case CUDD_REORDER_SIFT_CONVERGE: return "sifting (converge)";
+        case CUDD_REORDER_SYMM_SIFT: return "symmetric sifting";
+        case CUDD_REORDER_SYMM_SIFT_CONV: return "symmetric sifting (converge)";
+        case CUDD_REORDER_WINDOW2: return "window 2";
+        case CUDD_REORDER_WINDOW3: return "window 3";
+        case CUDD_REORDER_WINDOW4: return "window 4";
+        case CUDD_REORDER_WINDOW2_CONV: return "window 2 (converge)";
+        case CUDD_REORDER_WINDOW3_CONV: return "window 3 (converge)";
+        case CUDD_REORDER_WINDOW4_CONV: return "window 4 (converge)";
+        case CUDD_REORDER_GROUP_SIFT: return "group sifting";
+        case CUDD_REORDER_GROUP_SIFT_CONV: return "group sifting (converge)";
+        case CUDD_REORDER_ANNEALING: return "annealing";
+        case CUDD_REORDER_GENETIC: return "genetic";
+        case CUDD_REORDER_LINEAR: return "linear";
+        case CUDD_REORDER_LINEAR_CONVERGE: return "linear (converge)";
+        case CUDD_REORDER_LAZY_SIFT: return "lazy sifting";
+        case CUDD_REORDER_EXACT: return "exact";
+    }
+    return "?";
+}
+
 /*
  * Kiểm tra xem một marking cụ thể có nằm trong tập reachableStates hay không.
+ * marking[i] là số token thật của place i. Với 1-safe encoding, mọi giá trị > 0 được coi là 1;
+ * với binary encoding, giá trị vượt bound của place thì chắc chắn không reachable.
  */
 bool SymbolicPetriNet::contains(const vector<int>& marking) {
     if (marking.size() != net.places.size()) return false;
 
+    vector<int> counts(numPlaces);
+    for (int i = 0; i < numPlaces; i++) {
+        counts[i] = safeEncoding ? (marking[i] > 0 ? 1 : 0) : marking[i];
+        if (counts[i] < 0 || counts[i] > placeBound[i]) return false;
+    }
+    // Place không có biến: số token phải khớp với giá trị suy ra từ P-invariant
+    for (const ImpliedPlace& implied : impliedPlaces) {
+        if (impliedValue(implied.place, counts) != counts[implied.place]) return false;
+    }
+
     DdNode* temp = reachableStates;
     Cudd_Ref(temp); // Tăng ref count để giữ node gốc
 
     // Duyệt qua từng place để đi xuống cây BDD
-    for (size_t i = 0; i < net.places.size(); i++) {
-        string pId = net.places[i].id;
-        
-        // Tìm biến BDD tương ứng với place này
-        if (placeToCurrentVar.find(pId) == placeToCurrentVar.end()) {
-            Cudd_RecursiveDeref(BDD_ops, temp);
-            return false;
-        }
-        int varIdx = placeToCurrentVar[pId];
-
-        DdNode* varNode = Cudd_bddIthVar(BDD_ops, varIdx);
-        DdNode* nextNode;
+    for (int i = 0; i < numPlaces; i++) {
+        if (impliedIndex[i] >= 0) continue;
 
-        // Nếu marking tại place i là 1 -> đi theo nhánh THEN (AND với var)
-        // Nếu marking tại place i là 0 -> đi theo nhánh ELSE (AND với NOT var)
-        if (marking[i] > 0) {
-            nextNode = Cudd_bddAnd(BDD_ops, temp, varNode);
-        } else {
-            nextNode = Cudd_bddAnd(BDD_ops, temp, Cudd_Not(varNode));
-        }
-        
+        // AND với minterm của các bit biểu diễn số token tại place i
+        DdNode* value = bddValue(placeToCurrentVars[i], counts[i]);
+        DdNode* nextNode = Cudd_bddAnd(BDD_ops, temp, value);
         Cudd_Ref(nextNode);
+        Cudd_RecursiveDeref(BDD_ops, value);
         Cudd_RecursiveDeref(BDD_ops, temp); // Giảm ref node cũ
         temp = nextNode;
 
@@ -296,4 +999,183 @@ bool SymbolicPetriNet::contains(const vector<int>& marking) {
     bool result = (temp != Cudd_ReadLogicZero(BDD_ops));
     Cudd_RecursiveDeref(BDD_ops, temp);
     return result;
-}
\ No newline at end of file
+}
+
+/*
+ * Có marking reachable nào trùng với marking trên các place có fixed[p] != 0 không
+ * (các place còn lại tùy ý). Dùng để kiểm tra cả một cube một lần: cube được dựng bằng
+ * Cudd_bddComputeCube và so với ¬reachableStates bằng Cudd_bddLeq, không tạo BDD trung gian.
+ */
+bool SymbolicPetriNet::containsAny(const vector<int>& marking, const vector<char>& fixed) {
+    vector<DdNode*> vars;
+    vector<int> phases;
+    vector<int> impliedFixed;
+    for (int p = 0; p < numPlaces; p++) {
+        if (!fixed[p]) continue;
+        long long count = safeEncoding ? (marking[p] > 0 ? 1 : 0) : marking[p];
+        if (count < 0 || count > placeBound[p]) return false;
+        if (impliedIndex[p] >= 0) impliedFixed.push_back(p);
+        for (size_t b = 0; b < placeToCurrentVars[p].size(); b++) {
+            vars.push_back(Cudd_bddIthVar(BDD_ops, placeToCurrentVars[p][b]));
+            phases.push_back((count >> b) & 1);
+        }
+    }
+    DdNode* cube = Cudd_bddComputeCube(BDD_ops, vars.data(), phases.data(), (int)vars.size());
+    Cudd_Ref(cube);
+    // place không có biến: điều kiện M(p) = count trên các place của invariant, thêm vào cube
+    for (int p : impliedFixed) {
+        long long count = safeEncoding ? (marking[p] > 0 ? 1 : 0) : marking[p];
+        DdNode* range = impliedRange(p, count, count);
+        DdNode* temp = Cudd_bddAnd(BDD_ops, cube, range);
+        Cudd_Ref(temp);
+        Cudd_RecursiveDeref(BDD_ops, cube);
+        Cudd_RecursiveDeref(BDD_ops, range);
+        cube = temp;
+    }
+    bool unreachable = Cudd_bddLeq(BDD_ops, cube, Cudd_Not(reachableStates));
+    Cudd_RecursiveDeref(BDD_ops, cube);
+    return !unreachable;
+}
+
+/*
+ * Markings (over the current variables) where transIdx is enabled: every input place
+ * holds at least the arc weight. The 1-safe encoding only asks for the place to be marked,
+ * like its transition relation. Returns a referenced BDD.
+ */
+DdNode* SymbolicPetriNet::enablingCondition(int transIdx) {
+    DdNode* enabled = Cudd_ReadOne(BDD_ops);
+    Cudd_Ref(enabled);
+    for (const IncidenceEntry* e = compiled.preBegin(transIdx); e != compiled.preEnd(transIdx); ++e) {
+        DdNode* guard = placeAtLeast(e->place, safeEncoding ? 1 : e->weight);
+        DdNode* temp = Cudd_bddAnd(BDD_ops, enabled, guard);
+        Cudd_Ref(temp);
+        Cudd_RecursiveDeref(BDD_ops, enabled);
+        Cudd_RecursiveDeref(BDD_ops, guard);
+        enabled = temp;
+    }
+    return enabled;
+}
+
+//dead markings: no transition enabled, i.e. the conjunction of the negated enabling conditions (referenced)
+DdNode* SymbolicPetriNet::deadStates() {
+    DdNode* dead = Cudd_ReadOne(BDD_ops);
+    Cudd_Ref(dead);
+    for (int t = 0; t < numTransitions && dead != Cudd_ReadLogicZero(BDD_ops); t++) {
+        DdNode* enabled = enablingCondition(t);
+        DdNode* temp = Cudd_bddAnd(BDD_ops, dead, Cudd_Not(enabled));
+        Cudd_Ref(temp);
+        Cudd_RecursiveDeref(BDD_ops, dead);
+        Cudd_RecursiveDeref(BDD_ops, enabled);
+        dead = temp;
+    }
+    return dead;
+}
+
+//unit arc weights and M0 <= 1: the nets the 1-safe encoding can represent without merging weights
+bool SymbolicPetriNet::hasUnitSafeStructure() const {
+    for (int v : compiled.initialMarking()) {
+        if (v > 1) return false;
+    }
+    for (int t = 0; t < numTransitions; t++) {
+        for (const IncidenceEntry* e = compiled.preBegin(t); e != compiled.preEnd(t); ++e)
+            if (e->weight != 1) return false;
+        for (const IncidenceEntry* e = compiled.postBegin(t); e != compiled.postEnd(t); ++e)
+            if (e->weight != 1) return false;
+    }
+    return true;
+}
+
+/*
+ * Whether Σ y_p·M(p) = total on every marking of reachableStates, M(p) as the encoding
+ * stores it (0/1 in the 1-safe encoding). A P-invariant of the net always holds on an
+ * exact model; otherwise merged or cut firings may break it, so it has to be checked.
+ * Terms over implied places are not evaluated: false.
+ */
+bool SymbolicPetriNet::holdsOnReachable(const vector<pair<int, long long>>& terms, long long total) {
+    for (const auto& term : terms) {
+        if (impliedIndex[term.first] >= 0) return false;
+    }
+    DdNode* sum = weightedSum(terms);
+    DdNode* equal = Cudd_addBddInterval(BDD_ops, sum, (CUDD_VALUE_TYPE)total, (CUDD_VALUE_TYPE)total);
+    Cudd_Ref(equal);
+    Cudd_RecursiveDeref(BDD_ops, sum);
+    bool holds = Cudd_bddLeq(BDD_ops, reachableStates, equal);
+    Cudd_RecursiveDeref(BDD_ops, equal);
+    return holds;
+}
+
+/*
+ * Whether reachableStates is exactly the reachable set of the real net, i.e. the encoding
+ * never cut or merged a firing from a reachable marking:
+ *  - 1-safe encoding: unit weights, M0 <= 1, and no transition puts a token into an
+ *    already marked place (such tokens would be merged);
+ *  - binary encoding: no reachable firing would push a place past its bound.
+ * Only then do real-net conditions such as the state equation hold for every marking in it.
+ */
+bool SymbolicPetriNet::isExactModel() {
+    if (safeEncoding && !hasUnitSafeStructure()) return false;
+
+    std::vector<int> effect(numPlaces, 0);
+    for (int t = 0; t < numTransitions; t++) {
+        for (const IncidenceEntry* e = compiled.preBegin(t); e != compiled.preEnd(t); ++e) effect[e->place] -= e->weight;
+        for (const IncidenceEntry* e = compiled.postBegin(t); e != compiled.postEnd(t); ++e) effect[e->place] += e->weight;
+
+        // markings where firing t would overflow some place
+        DdNode* overflow = Cudd_ReadLogicZero(BDD_ops);
+        Cudd_Ref(overflow);
+        for (const IncidenceEntry* e = compiled.postBegin(t); e != compiled.postEnd(t); ++e) {
+            int p = e->place;
+            if (effect[p] <= 0) continue;
+            DdNode* full = placeAtLeast(p, (long long)placeBound[p] - effect[p] + 1);
+            DdNode* temp = Cudd_bddOr(BDD_ops, overflow, full);
+            Cudd_Ref(temp);
+            Cudd_RecursiveDeref(BDD_ops, overflow);
+            Cudd_RecursiveDeref(BDD_ops, full);
+            overflow = temp;
+        }
+        for (const IncidenceEntry* e = compiled.preBegin(t); e != compiled.preEnd(t); ++e) effect[e->place] = 0;
+        for (const IncidenceEntry* e = compiled.postBegin(t); e != compiled.postEnd(t); ++e) effect[e->place] = 0;
+
+        DdNode* enabled = enablingCondition(t);
+        DdNode* blocked = Cudd_bddAnd(BDD_ops, enabled, overflow);
+        Cudd_Ref(blocked);
+        Cudd_RecursiveDeref(BDD_ops, enabled);
+        Cudd_RecursiveDeref(BDD_ops, overflow);
+        bool exact = Cudd_bddLeq(BDD_ops, blocked, Cudd_Not(reachableStates));
+        Cudd_RecursiveDeref(BDD_ops, blocked);
+        if (!exact) return false;
+    }
+    return true;
+}
+
+/*
+ * Pick one marking of states with Cudd_bddPickOneMinterm over the current variables and
+ * decode it into token counts (indexed like net.places). Returns false if states is empty.
+ * Implied places are filled in from their invariants afterwards.
+ */
+bool SymbolicPetriNet::pickMarking(DdNode* states, vector<int>& marking) {
+    if (!states || states == Cudd_ReadLogicZero(BDD_ops)) return false;
+
+    vector<DdNode*> vars;
+    for (int p = 0; p < numPlaces; p++) {
+        for (int v : placeToCurrentVars[p]) vars.push_back(Cudd_bddIthVar(BDD_ops, v));
+    }
+    DdNode* minterm = Cudd_bddPickOneMinterm(BDD_ops, states, vars.data(), (int)vars.size());
+    if (!minterm) return false;
+    Cudd_Ref(minterm);
+
+    marking.assign(numPlaces, 0);
+    for (int p = 0; p < numPlaces; p++) {
+        for (size_t b = 0; b < placeToCurrentVars[p].size(); b++) {
+            // the minterm fixes every variable: it implies either x or ¬x
+            if (Cudd_bddLeq(BDD_ops, minterm, Cudd_bddIthVar(BDD_ops, placeToCurrentVars[p][b]))) {
+                marking[p] |= 1 << b;
+            }
+        }
+    }
+    Cudd_RecursiveDeref(BDD_ops, minterm);
+    for (const ImpliedPlace& implied : impliedPlaces) {
+        marking[implied.place] = (int)impliedValue(implied.place, marking);
+    }
+    return true;
+}
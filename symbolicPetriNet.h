@@ -2,34 +2,135 @@
 #define SYMBOLIC_PETRI_NET_H
 
 #include "petriNet.h"
+#include "compiledNet.h"
+#include "variableOrder.h"
+#include "mtr.h" //must precede cudd.h so that Cudd_MakeTreeNode is declared
 #include "cudd.h"
+#include "dddmp.h"
+#include <string>
 #include <map>
 #include <set>
 
+//how computeReachability() iterates towards the fixed point
+enum class ReachabilityStrategy {
+    FullImage, //image the whole reachable set every iteration (original scheme)
+    Frontier,  //image only the states discovered in the previous iteration
+    Chaining   //frontier + apply transitions one after another, each image feeding the next
+};
+
+//configuration chosen at construction time
+struct SymbolicOptions {
+    //place order on the BDD levels; current/next variables of a place are always adjacent (x0 x0' x1 x1' ...)
+    VariableOrder order = VariableOrder::Force;
+    //dynamic reordering method: CUDD_REORDER_SIFT, CUDD_REORDER_SYMM_SIFT, CUDD_REORDER_GROUP_SIFT,
+    //CUDD_REORDER_ANNEALING, ... CUDD_REORDER_NONE disables it. Each x/x' pair moves as one block.
+    Cudd_ReorderingType reordering = CUDD_REORDER_GROUP_SIFT;
+    ReachabilityStrategy strategy = ReachabilityStrategy::Frontier;
+    //token bound per place.
+    //  1: 1-safe encoding, one Boolean variable per place ("marked or not"), the original model.
+    //  k > 1: every place holds 0..k tokens, stored as a ceil(log2(k+1))-bit binary counter.
+    //  0: derive a bound per place from the net structure: P-invariants, else token conservation
+    //     (see computePlaceBounds()).
+    //With k != 1, arc weights are honoured and firings that would exceed the bound are not represented.
+    int tokenBound = 1;
+    //directory where reachable sets are persisted in dddmp binary form, file names keyed by
+    //cacheKey(); empty disables loadReachableStates()/storeReachableStates()
+    std::string cacheDirectory;
+    //also persist the transition relations; buildTransitionRelations() then loads them if present
+    bool cacheRelations = false;
+    //drop places whose token count follows from a P-invariant and the other places: they get no
+    //BDD variables, their value is reconstructed by contains()/pickMarking() and their guards are
+    //expressed over the places of the invariant. Only applied when the encoding is exact: every
+    //place must be bounded by P-invariants within its token bound (for the 1-safe encoding: a
+    //proven 1-safe net with unit weights); otherwise all places stay encoded.
+    bool eliminateImpliedPlaces = false;
+};
+
+const char* reorderingName(Cudd_ReorderingType method);
+
 class SymbolicPetriNet {
 public:
-    SymbolicPetriNet(const PetriNet& petriNet);
+    SymbolicPetriNet(const PetriNet& petriNet, const SymbolicOptions& options = SymbolicOptions());
     ~SymbolicPetriNet();
     void initialize();
     void encodeInitialMarking();
     void buildTransitionRelations();
     void computeReachability();
+    void computeReachabilitySaturation();
+    std::string cacheKey() const;
+    bool loadReachableStates();
+    void storeReachableStates();
     bool contains(const vector<int>& marking);
+    bool containsAny(const vector<int>& marking, const vector<char>& fixed);
+    DdNode* enablingCondition(int transIdx);
+    DdNode* deadStates();
+    bool isExactModel();
+    bool holdsOnReachable(const vector<pair<int, long long>>& terms, long long total);
+    bool pickMarking(DdNode* states, vector<int>& marking);
+    DdNode* getReachableStates() const { return reachableStates; }
+    int getNumCurrentVars() const { return numCurrentVars; }
     void printResults();
+    void printReorderingStats();
     DdManager* getBDDManager() const { return BDD_ops; }
+    const CompiledNet& getCompiledNet() const { return compiled; }
+    int getPlaceBound(int place) const { return placeBound[place]; }
+    bool isSafeEncoding() const { return safeEncoding; }
     long long getBDDMemory() const { return Cudd_ReadMemoryInUse(BDD_ops);}
 private:
     PetriNet net; //the petri net
+    CompiledNet compiled; //integer-indexed pre/post incidence, built once from net
+    SymbolicOptions options;
+    vector<int> placeOrder; //placeOrder[k] = place whose variable pair sits at position k
     DdManager* BDD_ops; //pointer to DdManager utilities to get useful BDD operations
-    map<string, int> placeToCurrentVar;//std::map uses a red black tree to sort 
-    map<string, int> placeToNextVar;
+    bool safeEncoding;             //tokenBound == 1: one Boolean per place
+    vector<int> placeBound;        //largest token count representable in place i
+    vector<vector<int>> placeToCurrentVars; //BDD variables of place i in the current state, least significant bit first
+    vector<vector<int>> placeToNextVars;    //same for the next state
+    int numCurrentVars;
     DdNode* initialState;
     DdNode* reachableStates;
-    vector<DdNode*> transitionRelations; //many many addresses of transition relations
+    //transition relation restricted to the places the transition touches (pre ∪ post);
+    //every other place keeps its value implicitly, so no frame constraints are stored
+    struct LocalRelation {
+        DdNode* relation;            //over x_p, x'_p of touched places only
+        DdNode* currentCube;         //cube of x_p of touched places, quantified by the image
+        vector<DdNode*> currentVars; //renaming x'_p -> x_p after quantification
+        vector<DdNode*> nextVars;
+    };
+    vector<LocalRelation> transitionRelations;
+    //place without variables: M(place) = (total - Σ y_q·M(q) over others) / weight, from a P-invariant
+    struct ImpliedPlace {
+        int place;
+        long long weight;
+        long long total;
+        vector<pair<int, long long>> others; //(q, y_q), all places with variables
+        DdNode* sum;                         //ADD of Σ y_q·M(q) over the current variables
+    };
+    vector<ImpliedPlace> impliedPlaces;
+    vector<int> impliedIndex; //index into impliedPlaces, -1 if the place has variables
     int numPlaces;
     int numTransitions;
 private:
-    DdNode* getTransitionRelation(int transIdx);
+    void computePlaceBounds();
+    void selectImpliedPlaces();
+    bool hasUnitSafeStructure() const;
+    long long impliedValue(int place, const vector<int>& marking) const;
+    DdNode* impliedRange(int place, long long low, long long high);
+    DdNode* placeAtLeast(int place, long long value);
+    DdNode* weightedSum(const vector<pair<int, long long>>& terms);
+    LocalRelation getTransitionRelation(int transIdx, DdNode* storedRelation = nullptr);
+    std::string cacheFile(const char* kind) const;
+    DdNode* tokenEffect(int place, int consumed, int produced);
+    DdNode* bddValue(const vector<int>& vars, long long value);
+    DdNode* bddAtLeast(const vector<int>& vars, long long value);
+    DdNode* bddAddConstant(const vector<int>& x, const vector<int>& y, long long delta);
+    DdNode* imageOf(int transIdx, DdNode* states);
     DdNode* imageComputation(DdNode* states);
+    void computeReachabilityFullImage();
+    void computeReachabilityFrontier();
+    void computeReachabilityChaining();
+    vector<int> chainingOrder() const;
+    DdNode* groupImage(const vector<int>& group, DdNode* states);
+    DdNode* saturate(DdNode* states, int groupIdx, const vector<vector<int>>& groups, long long& images);
 };
 #endif
\ No newline at end of file
@@ -1,11 +1,110 @@
 #include "petriNet.h"
 #include "symbolicPetriNet.h"
 #include "deadlockDetector.h"
+#include "invariants.h"
+#include "netReduction.h"
+#include "pnmlStream.h"
+#include "netCache.h"
+#include "packedNet.h"
+#include "parallelExplorer.h"
+#include "mddPetriNet.h"
+#include "zddPetriNet.h"
 #include <iostream>
+#include <fstream>
 #include <cassert>
+#include <filesystem>
+#include <unistd.h>
+#include <set>
+#include <zlib.h>
 
 using namespace std;
 
+struct NetArc {
+    string source, target;
+    int weight = 1;
+};
+
+//mạng dựng tay cho test: name = id, cung đánh id a1, a2, ... theo thứ tự
+PetriNet makeNet(const vector<string>& places, const vector<int>& m0, const vector<string>& transitions,
+                 const vector<NetArc>& arcs) {
+    PetriNet net;
+    for (size_t i = 0; i < places.size(); i++) {
+        Place p; p.id = places[i]; p.name = places[i]; p.initialMarking = m0[i];
+        net.places.push_back(p);
+    }
+    for (const string& id : transitions) {
+        Transition t; t.id = id; t.name = id;
+        net.transitions.push_back(t);
+    }
+    for (const NetArc& arc : arcs) {
+        Arc a; a.id = "a" + to_string(net.arcs.size() + 1); a.source = arc.source; a.target = arc.target; a.weight = arc.weight;
+        net.arcs.push_back(a);
+    }
+    return net;
+}
+
+//vòng length place, t_i: r_i -> r_{i+1}; tokens token rải đều, không giới hạn số token mỗi place
+PetriNet ringNet(int length, int tokens) {
+    vector<string> places, transitions;
+    vector<int> m0(length, 0);
+    vector<NetArc> arcs;
+    for (int i = 0; i < length; i++) {
+        places.push_back("r" + to_string(i));
+        transitions.push_back("t" + to_string(i));
+    }
+    for (int k = 0; k < tokens; k++) m0[k * length / tokens]++;
+    for (int i = 0; i < length; i++) {
+        arcs.push_back({places[i], transitions[i]});
+        arcs.push_back({transitions[i], places[(i + 1) % length]});
+    }
+    return makeNet(places, m0, transitions, arcs);
+}
+
+/*
+ * Mạng có trọng số, nhiều token mỗi place: A (6 token) -(2)-> T1 -> B, B -> T2 -(2)-> A,
+ * A -> T3 -> C, C + D -> T4 -> A + D (D là khóa 1 token). A + 2B + C = 6: 16 marking, A tới 6 token.
+ */
+PetriNet weightedNet() {
+    return makeNet({"a", "b", "c", "d"}, {6, 0, 0, 1}, {"t1", "t2", "t3", "t4"},
+                   {{"a", "t1", 2}, {"t1", "b"}, {"b", "t2"}, {"t2", "a", 2}, {"a", "t3"}, {"t3", "c"},
+                    {"c", "t4"}, {"d", "t4"}, {"t4", "a"}, {"t4", "d"}});
+}
+
+//dựng SymbolicPetriNet tới trước bước tính reachability
+void prepareSymbolic(SymbolicPetriNet& symNet) {
+    symNet.initialize();
+    symNet.encodeInitialMarking();
+    symNet.buildTransitionRelations();
+}
+
+//reachable set của symNet đúng bằng tập reachable (BFS): cùng số marking và chứa mọi marking của BFS
+bool matchesBFS(SymbolicPetriNet& symNet, const vector<Marking>& reachable) {
+    double count = Cudd_CountMinterm(symNet.getBDDManager(), symNet.getReachableStates(), symNet.getNumCurrentVars());
+    if (count != reachable.size()) return false;
+    for (const Marking& M : reachable)
+        if (!symNet.contains(M.tokens)) return false;
+    return true;
+}
+
+//file/thư mục tạm trong temp_directory_path(), bị xóa khi ra khỏi scope (kể cả khi test ném lỗi)
+struct ScopedPath {
+    std::filesystem::path path;
+    explicit ScopedPath(const string& name)
+        : path(std::filesystem::temp_directory_path() / ("test_task4_" + to_string(getpid()) + "_" + name)) {}
+    ~ScopedPath() {
+        std::error_code ignored;
+        std::filesystem::remove_all(path, ignored);
+    }
+    string str() const { return path.string(); }
+};
+
+//tập marking (không phụ thuộc thứ tự khám phá)
+set<vector<int>> markingSet(const vector<Marking>& markings) {
+    set<vector<int>> result;
+    for (const Marking& M : markings) result.insert(M.tokens);
+    return result;
+}
+
 void testLoadAndDetect() {
     cout << "\n[TEST 1] Loading simple_example.pnml and detecting deadlock..." << endl;
     try {
@@ -93,8 +192,729 @@ void testManualDeadlock() {
     }
 }
 
+void testSymbolicDeadlock() {
+    cout << "\n[TEST 3] Symbolic deadlock detection (no ILP)..." << endl;
+    /*
+     * P1 (1 token) -> T1 -> P2 -> T2 -> P3, và P3 -> T3 -> P3 (vòng tự lặp).
+     * Marking chết {P1=0, P2=0, P3=0} không reachable (ILP sẽ đề xuất nó trước),
+     * mọi marking reachable đều còn transition fire được => KHÔNG có deadlock.
+     * Bỏ T3 thì {0,0,1} là deadlock duy nhất.
+     */
+    PetriNet net = makeNet({"p1", "p2", "p3"}, {1, 0, 0}, {"t1", "t2", "t3"},
+                           {{"p1", "t1"}, {"t1", "p2"}, {"p2", "t2"}, {"t2", "p3"}, {"p3", "t3"}, {"t3", "p3"}});
+
+    try {
+        bool ok = true;
+        for (int withLoop = 1; withLoop >= 0; withLoop--) {
+            PetriNet variant = net;
+            if (!withLoop) {
+                variant.transitions.pop_back();
+                variant.arcs.resize(4);
+            }
+            SymbolicPetriNet symNet(variant);
+            symNet.initialize();
+            symNet.encodeInitialMarking();
+            symNet.buildTransitionRelations();
+            symNet.computeReachability();
+
+            DeadlockDetector detector(variant, symNet, DeadlockMethod::Symbolic);
+            bool hasDeadlock = detector.detectDeadlock();
+            detector.printResults();
+
+            vector<int> expected = {0, 0, 1};
+            if (withLoop && hasDeadlock) ok = false;
+            if (!withLoop && (!hasDeadlock || detector.getDeadlockMarking().tokens != expected)) ok = false;
+        }
+        cout << (ok ? "[TEST 3] PASSED: Symbolic deadlock detection is correct." 
+                    : "[TEST 3] FAILED: Wrong symbolic deadlock result.") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 3: " << e.what() << endl;
+    }
+}
+
+void testInvariants() {
+    cout << "\n[TEST 4] P-/T-invariants (Farkas)..." << endl;
+    /*
+     * P1 (2 token) -(2)-> T1 -> P2 -> T2 -(2)-> P1, P3 -> T3 (chỉ tiêu thụ).
+     * P-invariant duy nhất: P1 + 2*P2 = 2  => bound P1 = 2, P2 = 1, P3 không bị phủ (-1).
+     * T-invariant duy nhất: T1 + T2.
+     */
+    PetriNet net = makeNet({"p1", "p2", "p3"}, {2, 0, 0}, {"t1", "t2", "t3"},
+                           {{"p1", "t1", 2}, {"t1", "p2"}, {"p2", "t2"}, {"t2", "p1", 2}, {"p3", "t3"}});
+
+    try {
+        CompiledNet compiled(net);
+        InvariantResult pInv = computePInvariants(compiled);
+        InvariantResult tInv = computeTInvariants(compiled);
+        printInvariants(net, pInv, tInv);
+
+        vector<pair<int, long long>> expectedP = {{0, 1}, {1, 2}};
+        vector<pair<int, long long>> expectedT = {{0, 1}, {1, 1}};
+        vector<long long> expectedBounds = {2, 1, -1};
+        bool ok = pInv.complete && tInv.complete &&
+                  pInv.invariants.size() == 1 && pInv.invariants[0].entries == expectedP &&
+                  tInv.invariants.size() == 1 && tInv.invariants[0].entries == expectedT &&
+                  invariantBounds(compiled, pInv.invariants) == expectedBounds;
+        cout << (ok ? "[TEST 4] PASSED: Invariants and bounds are correct."
+                    : "[TEST 4] FAILED: Wrong invariants.") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 4: " << e.what() << endl;
+    }
+}
+
+void testImpliedPlaces() {
+    cout << "\n[TEST 5] Eliminating places implied by P-invariants..." << endl;
+    /*
+     * P1 (2 token) -(2)-> T1 -> P2 -> T2 -(2)-> P1, P2 -> T3 -> P3 (mạng của TEST 4, T3 đổi hướng).
+     * P-invariant P1 + 2*P2 + 2*P3 = 2 => một place không cần biến BDD.
+     * Reachable: {2,0,0}, {0,1,0}, {0,0,1}; {0,0,1} là deadlock. Kết quả phải giống encoding đầy đủ.
+     */
+    PetriNet net = makeNet({"p1", "p2", "p3"}, {2, 0, 0}, {"t1", "t2", "t3"},
+                           {{"p1", "t1", 2}, {"t1", "p2"}, {"p2", "t2"}, {"t2", "p1", 2}, {"p2", "t3"}, {"t3", "p3"}});
+
+    try {
+        bool ok = true;
+        for (int eliminate = 0; eliminate <= 1; eliminate++) {
+            SymbolicOptions options;
+            options.tokenBound = 0;
+            options.eliminateImpliedPlaces = eliminate;
+            SymbolicPetriNet symNet(net, options);
+            symNet.initialize();
+            symNet.encodeInitialMarking();
+            symNet.buildTransitionRelations();
+            symNet.computeReachability();
+
+            double states = Cudd_CountMinterm(symNet.getBDDManager(), symNet.getReachableStates(),
+                                              symNet.getNumCurrentVars());
+            if (states != 3 || !symNet.contains({2, 0, 0}) || !symNet.contains({0, 1, 0}) ||
+                !symNet.contains({0, 0, 1}) || symNet.contains({1, 0, 0}) || symNet.contains({0, 0, 0})) ok = false;
+            if (eliminate && symNet.getNumCurrentVars() >= 4) ok = false; //P1 (2 bit) + P2 + P3 khi đầy đủ
+
+            DeadlockDetector detector(net, symNet, DeadlockMethod::Symbolic);
+            vector<int> expected = {0, 0, 1};
+            if (!detector.detectDeadlock() || detector.getDeadlockMarking().tokens != expected) ok = false;
+        }
+
+        //mã hóa 1-safe mặc định: vòng 12 place 1 token là 1-safe đã chứng minh => bỏ được 1 place;
+        //4 token thì mã hóa gộp token (793 marking) => không được bỏ place nào, bật hay tắt đều như nhau
+        for (int tokens : {1, 4}) {
+            PetriNet ring = ringNet(12, tokens);
+            for (int eliminate = 0; eliminate <= 1; eliminate++) {
+                SymbolicOptions options;
+                options.eliminateImpliedPlaces = eliminate;
+                SymbolicPetriNet symNet(ring, options);
+                prepareSymbolic(symNet);
+                symNet.computeReachability();
+                double states = Cudd_CountMinterm(symNet.getBDDManager(), symNet.getReachableStates(),
+                                                  symNet.getNumCurrentVars());
+                int vars = eliminate && tokens == 1 ? 11 : 12;
+                if (states != (tokens == 1 ? 12 : 793) || symNet.getNumCurrentVars() != vars) ok = false;
+            }
+        }
+        cout << (ok ? "[TEST 5] PASSED: Implied places are reconstructed correctly."
+                    : "[TEST 5] FAILED: Wrong result with implied places eliminated.") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 5: " << e.what() << endl;
+    }
+}
+
+void testNetReduction() {
+    cout << "\n[TEST 6] Structural net reduction..." << endl;
+    /*
+     * P1 (1 token) -> T1 -> P2 -> T2 -> P3 (mạng của TEST 3 không có T3), thêm Q song song với P2
+     * (cùng pre/post) và T2b giống hệt T2.
+     * Gộp nối tiếp đưa token về P3, Q trùng P2, T2b trùng T2: còn lại mạng rỗng, và marking
+     * chết duy nhất của nó mở rộng thành {P1=0, P2=0, Q=0, P3=1}.
+     */
+    PetriNet net = makeNet({"p1", "p2", "q", "p3"}, {1, 0, 0, 0}, {"t1", "t2", "t2b"},
+                           {{"p1", "t1"}, {"t1", "p2"}, {"t1", "q"}, {"p2", "t2"}, {"q", "t2"}, {"t2", "p3"},
+                            {"p2", "t2b"}, {"q", "t2b"}, {"t2b", "p3"}});
+
+    try {
+        ReducedNet reduced = reduceNet(net);
+        printReductionInfo(net, reduced);
+
+        Marking dead;
+        vector<int> expected = {0, 0, 0, 1};
+        bool ok = reduced.net.places.empty() && reduced.net.transitions.empty() &&
+                  reduced.stats.identicalTransitions == 1 && reduced.expand(dead).tokens == expected;
+        cout << (ok ? "[TEST 6] PASSED: Net reduced and marking mapped back correctly."
+                    : "[TEST 6] FAILED: Wrong reduction result.") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 6: " << e.what() << endl;
+    }
+}
+
+//hai mạng giống hệt nhau từng trường (id, name, marking, cung), cùng thứ tự
+bool sameNet(const PetriNet& a, const PetriNet& b) {
+    bool ok = a.places.size() == b.places.size() && a.transitions.size() == b.transitions.size() &&
+              a.arcs.size() == b.arcs.size();
+    for (size_t i = 0; ok && i < a.places.size(); i++)
+        ok = a.places[i].id == b.places[i].id && a.places[i].name == b.places[i].name &&
+             a.places[i].initialMarking == b.places[i].initialMarking;
+    for (size_t i = 0; ok && i < a.transitions.size(); i++)
+        ok = a.transitions[i].id == b.transitions[i].id && a.transitions[i].name == b.transitions[i].name;
+    for (size_t i = 0; ok && i < a.arcs.size(); i++)
+        ok = a.arcs[i].id == b.arcs[i].id && a.arcs[i].source == b.arcs[i].source &&
+             a.arcs[i].target == b.arcs[i].target && a.arcs[i].weight == b.arcs[i].weight;
+    return ok;
+}
+
+void testStreamingLoader() {
+    cout << "\n[TEST 7] Streaming PNML loader vs loadPNML()..." << endl;
+    try {
+        bool ok = sameNet(loadPNML("simple_example.pnml"), loadPNMLStream("simple_example.pnml"));
+
+        //các đường XmlPullParser tự xử lý: khai báo, DOCTYPE, comment, \r\n, entity và &#..;,
+        //CDATA, thẻ rỗng, <text> có con đầu tiên là element, initialMarking không phải số
+        ScopedPath file("streaming.pnml");
+        ofstream out(file.str(), ios::binary);
+        out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n"
+               "<!DOCTYPE pnml>\r\n"
+               "<!-- comment before the root -->\r\n"
+               "<pnml><net id=\"n\" type=\"P/T\"><!-- comment in the net -->\r\n"
+               "<place id=\"p&amp;1\"><name><text>A &lt;&amp;&gt; &quot;B&quot; &#x41;&#66;&#x1EA0;</text></name>"
+               "<initialMarking><text>2</text></initialMarking></place>\r\n"
+               "<place id=\'p2\'><name><text><![CDATA[<raw> & text]]></text></name>"
+               "<initialMarking><text>many</text></initialMarking></place>\r\n"
+               "<place id=\"p3\"><name><text>line1\r\nline2</text></name>"
+               "<initialMarking><text><graphics/>7</text></initialMarking></place>\r\n"
+               "<place id=\"p4\"/>\r\n"
+               "<transition id=\"t1\"><name><text><b>bold</b> rest</text></name></transition>\r\n"
+               "<transition id=\"t2\"><name><text>&#9;tab</text></name></transition>\r\n"
+               "<arc id=\"a1\" source=\"p&amp;1\" target=\"t1\"/>\r\n"
+               "<arc id=\"a2\" source=\"t1\" target=\"p2\"><inscription><text>1</text></inscription></arc>\r\n"
+               "</net></pnml>\r\n";
+        out.close();
+
+        PetriNet dom = loadPNML(file.str());
+        PetriNet stream = loadPNMLStream(file.str());
+        ok = ok && sameNet(dom, stream) && stream.places.size() == 4 && stream.transitions.size() == 2 &&
+             stream.places[0].id == "p&1" && stream.places[0].name == "A <&> \"B\" AB\xE1\xBA\xA0" &&
+             stream.places[0].initialMarking == 2 &&
+             stream.places[1].name == "<raw> & text" && stream.places[1].initialMarking == 0 &&
+             stream.places[2].name == "line1\nline2" && stream.places[2].initialMarking == 0 &&
+             stream.places[3].name.empty() && stream.transitions[0].name.empty() && stream.transitions[1].name == "\ttab" &&
+             stream.arcs.size() == 2 && stream.arcs[0].source == "p&1";
+        cout << (ok ? "[TEST 7] PASSED: Streaming loader builds the same net."
+                    : "[TEST 7] FAILED: Streaming loader differs from loadPNML().") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 7: " << e.what() << endl;
+    }
+}
+
+void testNetCache() {
+    cout << "\n[TEST 8] Binary net cache (mmap)..." << endl;
+    try {
+        PetriNet net = loadPNMLStream("simple_example.pnml");
+        verify(net);
+        uint64_t hash = hashFileContents("simple_example.pnml");
+        ScopedPath dir("net_cache");
+        string cacheFile = (dir.path / "bdd_cache" / "test_task4.net").string(); //thư mục cha do writeNetCache() tạo
+        writeNetCache(cacheFile, net, hash);
+        auto readBytes = [&cacheFile]() {
+            ifstream in(cacheFile, ios::binary);
+            return string((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        };
+        string written = readBytes();
+
+        //hash cũ: open() từ chối nhưng không xóa hay sửa file cache đang có
+        NetCache cache, stale;
+        bool ok = !stale.open(cacheFile, hash + 1) && !written.empty() && readBytes() == written &&
+                  cache.open(cacheFile, hash);
+        CompiledNet ref(net);
+        const CompiledNet& mapped = cache.compiled();
+        ok = ok && mapped.numPlaces() == ref.numPlaces() && mapped.numTransitions() == ref.numTransitions() &&
+             mapped.initialMarking() == ref.initialMarking();
+        for (int t = 0; ok && t < ref.numTransitions(); t++) {
+            ok = mapped.preSize(t) == ref.preSize(t) && mapped.postSize(t) == ref.postSize(t);
+            for (int k = 0; ok && k < ref.preSize(t); k++)
+                ok = mapped.preBegin(t)[k].place == ref.preBegin(t)[k].place && mapped.preBegin(t)[k].weight == ref.preBegin(t)[k].weight;
+            for (int k = 0; ok && k < ref.postSize(t); k++)
+                ok = mapped.postBegin(t)[k].place == ref.postBegin(t)[k].place && mapped.postBegin(t)[k].weight == ref.postBegin(t)[k].weight;
+        }
+        for (size_t p = 0; ok && p < net.places.size(); p++)
+            ok = cache.findPlace(net.places[p].id) == (int)p && net.places[p].name == cache.placeName(p);
+        for (size_t t = 0; ok && t < net.transitions.size(); t++)
+            ok = cache.findTransition(net.transitions[t].id) == (int)t;
+        PetriNet back = cache.toPetriNet();
+        ok = ok && cache.findPlace("missing") == -1 && back.arcs.size() == net.arcs.size();
+        for (size_t i = 0; ok && i < net.arcs.size(); i++)
+            ok = back.arcs[i].id == net.arcs[i].id && back.arcs[i].source == net.arcs[i].source &&
+                 back.arcs[i].target == net.arcs[i].target && back.arcs[i].weight == net.arcs[i].weight;
+        ok = ok && BFS(mapped).size() == BFS(net).size();
+        cout << (ok ? "[TEST 8] PASSED: Cached net matches the parsed net."
+                    : "[TEST 8] FAILED: Cached net differs from the parsed net.") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 8: " << e.what() << endl;
+    }
+}
+
+void testGzipLoader() {
+    cout << "\n[TEST 9] Loading gzip-compressed PNML..." << endl;
+    try {
+        //nén simple_example.pnml bằng zlib rồi đọc lại qua loadPNML()
+        ifstream in("simple_example.pnml", ios::binary);
+        string xml((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        ScopedPath file("simple_example.pnml.gz");
+        gzFile out = gzopen(file.str().c_str(), "wb");
+        if (!out || gzwrite(out, xml.data(), xml.size()) != (int)xml.size() || gzclose(out) != Z_OK)
+            throw runtime_error("Cannot write " + file.str());
+
+        PetriNet plain = loadPNML("simple_example.pnml");
+        PetriNet gz = loadPNML(file.str());
+        bool ok = plain.places.size() == gz.places.size() && plain.transitions.size() == gz.transitions.size() &&
+                  plain.arcs.size() == gz.arcs.size();
+        for (size_t i = 0; ok && i < plain.places.size(); i++)
+            ok = plain.places[i].id == gz.places[i].id && plain.places[i].initialMarking == gz.places[i].initialMarking;
+        for (size_t i = 0; ok && i < plain.arcs.size(); i++)
+            ok = plain.arcs[i].source == gz.arcs[i].source && plain.arcs[i].target == gz.arcs[i].target;
+        cout << (ok ? "[TEST 9] PASSED: Compressed PNML loads the same net."
+                    : "[TEST 9] FAILED: Compressed PNML differs from the plain file.") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 9: " << e.what() << endl;
+    }
+}
+
+void testMultiPageLoader() {
+    cout << "\n[TEST 10] Multi-page PNML with reference nodes..." << endl;
+    try {
+        //P1 -> T1 -> P2 qua referencePlace; T2 ở page lồng, nối P2 -> T2 -> P1 qua chuỗi 2 referenceTransition
+        ScopedPath file("multi_page.pnml");
+        ofstream out(file.str());
+        out << "<pnml><net id=\"n\">"
+               "<page id=\"g1\"><place id=\"P1\"><initialMarking><text>1</text></initialMarking></place>"
+               "<transition id=\"T1\"/><referencePlace id=\"R2\" ref=\"P2\"/>"
+               "<arc id=\"a1\" source=\"P1\" target=\"T1\"/><arc id=\"a2\" source=\"T1\" target=\"R2\"/></page>"
+               "<page id=\"g2\"><place id=\"P2\"/>"
+               "<page id=\"g3\"><transition id=\"T2\"/><referenceTransition id=\"RT\" ref=\"RT0\"/>"
+               "<referenceTransition id=\"RT0\" ref=\"T2\"/>"
+               "<arc id=\"a3\" source=\"P2\" target=\"RT\"/><arc id=\"a4\" source=\"RT\" target=\"P1\"/></page></page>"
+               "</net></pnml>";
+        out.close();
+
+        PetriNet dom = loadPNML(file.str());
+        PetriNet stream = loadPNMLStream(file.str());
+        verify(dom);
+        bool ok = dom.places.size() == 2 && dom.transitions.size() == 2 && dom.arcs.size() == 4 &&
+                  dom.arcs[1].target == "P2" && dom.arcs[2].target == "T2" && dom.arcs[3].source == "T2" &&
+                  stream.arcs.size() == dom.arcs.size() && BFS(dom).size() == 2;
+        for (size_t i = 0; ok && i < dom.arcs.size(); i++)
+            ok = dom.arcs[i].source == stream.arcs[i].source && dom.arcs[i].target == stream.arcs[i].target;
+        cout << (ok ? "[TEST 10] PASSED: Pages merged and references resolved."
+                    : "[TEST 10] FAILED: Wrong multi-page net.") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 10: " << e.what() << endl;
+    }
+}
+
+void testPackedBFS() {
+    cout << "\n[TEST 11] Bit-packed BFS vs vector<int> BFS..." << endl;
+    /*
+     * 4 làn 80 place, mỗi làn 1 token ở vị trí 0; t_i đẩy cả 4 token từ vị trí i sang i+1 (vòng).
+     * Mỗi transition chạm 4 word khác nhau nên đường 4 word/lần (AVX2) được dùng. Mạng 1-safe, 80 marking.
+     */
+    const int lanes = 4, length = 80;
+    vector<string> places, transitions;
+    vector<int> m0;
+    vector<NetArc> arcs;
+    auto place = [&](int lane, int i) { return "p" + to_string(lane) + "_" + to_string(i % length); };
+    for (int lane = 0; lane < lanes; lane++)
+        for (int i = 0; i < length; i++) {
+            places.push_back(place(lane, i));
+            m0.push_back(i == 0);
+        }
+    for (int i = 0; i < length; i++) {
+        transitions.push_back("t" + to_string(i));
+        for (int lane = 0; lane < lanes; lane++) {
+            arcs.push_back({place(lane, i), transitions.back()});
+            arcs.push_back({transitions.back(), place(lane, i + 1)});
+        }
+    }
+    try {
+        CompiledNet compiled(makeNet(places, m0, transitions, arcs));
+        vector<Marking> packed;
+        bool usedPacked = packedBFS(compiled, packed);
+        vector<Marking> ints = intBFS(compiled);
+        bool ok = usedPacked && packed.size() == (size_t)length && packed == ints && BFS(compiled) == packed;
+        cout << "AVX2: " << (PackedNet::usesAvx2() ? "yes" : "no") << endl;
+        cout << (ok ? "[TEST 11] PASSED: Packed BFS matches the int BFS."
+                    : "[TEST 11] FAILED: Packed BFS differs from the int BFS.") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 11: " << e.what() << endl;
+    }
+}
+
+void testParallelBFS() {
+    cout << "\n[TEST 12] Parallel BFS vs BFS..." << endl;
+    /*
+     * Vòng 12 place / 4 token (C(15,4) = 1365 marking, dùng vector<int>), mạng của TEST 5 (trọng số 2)
+     * và simple_example.pnml (1-safe, bit-packed). Cùng số state và cùng tập marking với mọi số thread.
+     */
+    try {
+        vector<PetriNet> nets = {ringNet(12, 4),
+                                 makeNet({"p1", "p2", "p3"}, {2, 0, 0}, {"t1", "t2", "t3"},
+                                         {{"p1", "t1", 2}, {"t1", "p2"}, {"p2", "t2"}, {"t2", "p1", 2}, {"p2", "t3"}, {"t3", "p3"}}),
+                                 loadPNML("simple_example.pnml")};
+        bool ok = BFS(nets[0]).size() == 1365;
+        for (const PetriNet& net : nets) {
+            vector<Marking> expected = BFS(net);
+            for (int threads : {1, 3, 8}) {
+                vector<Marking> parallel = parallelBFS(net, threads);
+                if (parallel.size() != expected.size() || markingSet(parallel) != markingSet(expected)) ok = false;
+            }
+        }
+        cout << (ok ? "[TEST 12] PASSED: Parallel BFS finds the same markings."
+                    : "[TEST 12] FAILED: Parallel BFS differs from BFS.") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 12: " << e.what() << endl;
+    }
+}
+
+void testSaturation() {
+    cout << "\n[TEST 13] Saturation vs iterative reachability (same BDD manager)..." << endl;
+    try {
+        bool ok = true;
+        vector<pair<PetriNet, int>> cases = {{ringNet(12, 4), 4}, {weightedNet(), 0}, {loadPNML("simple_example.pnml"), 1}};
+        for (const auto& c : cases) {
+            SymbolicOptions options;
+            options.tokenBound = c.second;
+            SymbolicPetriNet symNet(c.first, options);
+            prepareSymbolic(symNet);
+            DdManager* mgr = symNet.getBDDManager();
+
+            symNet.computeReachability();
+            DdNode* iterative = symNet.getReachableStates();
+            Cudd_Ref(iterative);
+            symNet.computeReachabilitySaturation();
+            DdNode* saturated = symNet.getReachableStates();
+            if (!Cudd_bddLeq(mgr, iterative, saturated) || !Cudd_bddLeq(mgr, saturated, iterative)) ok = false;
+            Cudd_RecursiveDeref(mgr, iterative);
+        }
+        cout << (ok ? "[TEST 13] PASSED: Saturation reaches the same set."
+                    : "[TEST 13] FAILED: Saturation differs from computeReachability().") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 13: " << e.what() << endl;
+    }
+}
+
+void testReachabilityStrategies() {
+    cout << "\n[TEST 14] FullImage / Frontier / Chaining give the same reachable set..." << endl;
+    try {
+        bool ok = true;
+        vector<pair<PetriNet, int>> cases = {{ringNet(12, 4), 4}, {weightedNet(), 6}};
+        for (const auto& c : cases) {
+            vector<Marking> reachable = BFS(c.first);
+            for (ReachabilityStrategy strategy : {ReachabilityStrategy::FullImage, ReachabilityStrategy::Frontier,
+                                                  ReachabilityStrategy::Chaining}) {
+                SymbolicOptions options;
+                options.tokenBound = c.second;
+                options.strategy = strategy;
+                SymbolicPetriNet symNet(c.first, options);
+                prepareSymbolic(symNet);
+                symNet.computeReachability();
+                if (!matchesBFS(symNet, reachable)) ok = false;
+            }
+        }
+        cout << (ok ? "[TEST 14] PASSED: All strategies reach the BFS set."
+                    : "[TEST 14] FAILED: A strategy reaches a different set.") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 14: " << e.what() << endl;
+    }
+}
+
+void testBinaryCounters() {
+    cout << "\n[TEST 15] k-bounded encoding with binary token counters..." << endl;
+    /*
+     * Bound k >= số token lớn nhất của mọi marking reachable => tập reachable giống hệt BFS,
+     * kể cả khi k không phải 2^n - 1 (giá trị > k của counter phải bị loại).
+     */
+    try {
+        bool ok = true;
+        vector<pair<PetriNet, vector<int>>> cases = {{weightedNet(), {6, 7, 10}}, {ringNet(12, 4), {4, 5}}};
+        for (const auto& c : cases) {
+            vector<Marking> reachable = BFS(c.first);
+            for (int k : c.second) {
+                SymbolicOptions options;
+                options.tokenBound = k;
+                SymbolicPetriNet symNet(c.first, options);
+                prepareSymbolic(symNet);
+                symNet.computeReachability();
+                if (symNet.isSafeEncoding() || symNet.getPlaceBound(0) != k || !matchesBFS(symNet, reachable)) ok = false;
+            }
+        }
+        cout << (ok ? "[TEST 15] PASSED: tokenBound = k matches BFS."
+                    : "[TEST 15] FAILED: Wrong k-bounded reachable set.") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 15: " << e.what() << endl;
+    }
+}
+
+void testMddReachability() {
+    cout << "\n[TEST 16] MDD reachability vs BFS..." << endl;
+    try {
+        bool ok = true;
+        for (const PetriNet& net : {weightedNet(), ringNet(12, 4)}) {
+            vector<Marking> reachable = BFS(net);
+            for (int saturation = 0; saturation <= 1; saturation++) {
+                MddPetriNet mdd(net);
+                mdd.initialize();
+                mdd.encodeInitialMarking();
+                mdd.buildTransitionRelations();
+                if (saturation) mdd.computeReachabilitySaturation();
+                else mdd.computeReachability();
+                if (mdd.countStates() != reachable.size()) ok = false;
+                for (const Marking& M : reachable)
+                    if (!mdd.contains(M.tokens)) ok = false;
+                if (mdd.contains(vector<int>(net.places.size(), 0))) ok = false; //không reachable ở cả 2 mạng
+            }
+        }
+        cout << (ok ? "[TEST 16] PASSED: MDD engines match BFS."
+                    : "[TEST 16] FAILED: MDD reachable set differs from BFS.") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 16: " << e.what() << endl;
+    }
+}
+
+void testZddVsBdd() {
+    cout << "\n[TEST 17] ZDD vs 1-safe BDD state counts..." << endl;
+    /*
+     * Cùng ngữ nghĩa 1-safe (trọng số bỏ qua, place chỉ "có/không có token"), nên số marking của
+     * ZDD phải bằng số minterm của SymbolicPetriNet mã hóa 1-safe, kể cả trên mạng không safe.
+     */
+    try {
+        bool ok = true;
+        for (const PetriNet& net : {ringNet(12, 4), ringNet(16, 1), weightedNet(), loadPNML("simple_example.pnml")}) {
+            ZddPetriNet zdd(net);
+            zdd.initialize();
+            zdd.encodeInitialMarking();
+            zdd.computeReachability();
+
+            SymbolicPetriNet symNet(net);
+            prepareSymbolic(symNet);
+            symNet.computeReachability();
+            double bddStates = Cudd_CountMinterm(symNet.getBDDManager(), symNet.getReachableStates(),
+                                                 symNet.getNumCurrentVars());
+            if (zdd.countStates() != bddStates) ok = false;
+        }
+        cout << (ok ? "[TEST 17] PASSED: ZDD and BDD count the same markings."
+                    : "[TEST 17] FAILED: ZDD and BDD state counts differ.") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 17: " << e.what() << endl;
+    }
+}
+
+void testReachableStatesCache() {
+    cout << "\n[TEST 18] Storing and reloading reachable states (dddmp)..." << endl;
+    try {
+        ScopedPath dir("bdd_cache");
+        SymbolicOptions options;
+        options.tokenBound = 4;
+        options.cacheDirectory = dir.str();
+        options.cacheRelations = true;
+        PetriNet net = ringNet(12, 4);
+
+        SymbolicPetriNet first(net, options);
+        first.initialize();
+        first.encodeInitialMarking();
+        bool ok = !first.loadReachableStates(); //thư mục rỗng
+        first.buildTransitionRelations();
+        first.computeReachability();
+        first.storeReachableStates();
+        double stored = Cudd_CountMinterm(first.getBDDManager(), first.getReachableStates(), first.getNumCurrentVars());
+
+        //manager mới: tập reachable và transition relation đều đọc lại từ file
+        SymbolicPetriNet second(net, options);
+        second.initialize();
+        second.encodeInitialMarking();
+        ok = ok && second.loadReachableStates() && stored == 1365 &&
+             Cudd_CountMinterm(second.getBDDManager(), second.getReachableStates(), second.getNumCurrentVars()) == stored &&
+             matchesBFS(second, BFS(net));
+        second.buildTransitionRelations();
+        second.computeReachability();
+        ok = ok && matchesBFS(second, BFS(net));
+        cout << (ok ? "[TEST 18] PASSED: Reloaded reachable set matches the stored one."
+                    : "[TEST 18] FAILED: Reloaded reachable set differs.") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 18: " << e.what() << endl;
+    }
+}
+
+void testInvariantRows() {
+    cout << "\n[TEST 19] P-invariant rows only where the BDD model keeps them..." << endl;
+    try {
+        //1 token trên vòng: mã hóa 1-safe chính xác, r0 + ... + r3 = 1 đúng trên mọi marking
+        //2 token trên vòng 6: token có thể dồn vào một place, mã hóa 1-safe gộp lại => tổng giảm còn 1
+        bool ok = true;
+        for (int tokens : {1, 2}) {
+            PetriNet net = ringNet(tokens == 1 ? 4 : 6, tokens);
+            SymbolicPetriNet symNet(net);
+            prepareSymbolic(symNet);
+            symNet.computeReachability();
+            InvariantResult pInv = computePInvariants(symNet.getCompiledNet());
+            ok = ok && pInv.invariants.size() == 1 && symNet.isExactModel() == (tokens == 1) &&
+                 symNet.holdsOnReachable(pInv.invariants[0].entries, tokens) == (tokens == 1);
+        }
+
+        //simple_example: invariant P1 + P2 + P3 = 3 không đúng trong mô hình, ILP không được dùng nó
+        //và phải tìm ra cùng deadlock với cách thuần BDD
+        PetriNet net = loadPNML("simple_example.pnml");
+        SymbolicPetriNet symNet(net);
+        prepareSymbolic(symNet);
+        symNet.computeReachability();
+        InvariantResult pInv = computePInvariants(symNet.getCompiledNet());
+        ok = ok && pInv.invariants.size() == 1 && !symNet.holdsOnReachable(pInv.invariants[0].entries, 3);
+        DeadlockDetector ilp(net, symNet, DeadlockMethod::IlpCegar);
+        DeadlockDetector bdd(net, symNet, DeadlockMethod::Symbolic);
+        ok = ok && ilp.detectDeadlock() && bdd.detectDeadlock() && symNet.contains(ilp.getDeadlockMarking().tokens);
+        cout << (ok ? "[TEST 19] PASSED: Invariant rows are sound for the encoded model."
+                    : "[TEST 19] FAILED: Invariant check disagrees with the model.") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 19: " << e.what() << endl;
+    }
+}
+
+void testSeriesTransitionsAndSelfLoops() {
+    cout << "\n[TEST 20] Series transitions and self-loop places..." << endl;
+    /*
+     * A + B + L -> T1 -> P + L, P -> T2 -> C + A; A, B, L có 1 token.
+     *  - L chỉ nằm trong self-loop của T1, M0 = 1 đủ => bỏ (hằng 1).
+     *  - P: M0 = 0, •P = {T1}, P• = {T2}, •T2 = {P} => T2 gộp vào T1: A + B -> T1 -> A + C.
+     *  - Vòng sau: A thành self-loop của T1 => bỏ; T1: B -> C gộp B vào C (M0(C) = 1), C không còn
+     *    cung nào => bỏ như place thừa (hằng 1).
+     * Còn lại mạng rỗng; marking chết mở rộng thành {A=1, B=0, L=1, P=0, C=1}.
+     */
+    PetriNet net = makeNet({"a", "b", "l", "p", "c"}, {1, 1, 1, 0, 0}, {"t1", "t2"},
+                           {{"a", "t1"}, {"b", "t1"}, {"l", "t1"}, {"t1", "p"}, {"t1", "l"},
+                            {"p", "t2"}, {"t2", "c"}, {"t2", "a"}});
+
+    try {
+        ReducedNet reduced = reduceNet(net);
+        printReductionInfo(net, reduced);
+
+        Marking dead;
+        vector<int> expected = {1, 0, 1, 0, 1};
+        vector<Marking> reachable = BFS(net);
+        bool ok = reduced.stats.seriesTransitions == 1 && reduced.stats.redundantPlaces == 3 &&
+                  reduced.stats.seriesPlaces == 1 && reduced.net.places.empty() && reduced.net.transitions.empty() &&
+                  reduced.expand(dead).tokens == expected &&
+                  markingSet(reachable).count(expected) == 1;
+        cout << (ok ? "[TEST 20] PASSED: Series transitions fused and self-loop places removed."
+                    : "[TEST 20] FAILED: Wrong reduction result.") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 20: " << e.what() << endl;
+    }
+}
+
+void testStaleSymbols() {
+    cout << "\n[TEST 21] Symbol table after ids are edited..." << endl;
+    try {
+        PetriNet net = makeNet({"p1", "p2", "p1"}, {1, 0, 0}, {"t1", "t2"},
+                               {{"p1", "t1"}, {"t1", "p2"}, {"p2", "t2"}, {"t2", "p1"}});
+        net.symbols.build(net);
+        SymbolTable scratch;
+        //id trùng (p1 hai lần): bảng vẫn khớp, id trỏ tới lần xuất hiện đầu
+        bool ok = &symbolsOf(net, scratch) == &net.symbols && net.symbols.place("p1") == 0;
+
+        //cùng số phần tử nhưng id đổi chỗ / đổi tên: phải dựng lại bảng
+        swap(net.places[0].id, net.places[1].id);
+        const SymbolTable& swapped = symbolsOf(net, scratch);
+        ok = ok && &swapped == &scratch && swapped.place("p2") == 0 && swapped.place("p1") == 1;
+        net.symbols.build(net);
+        net.transitions[1].id = "t3";
+        const SymbolTable& renamed = symbolsOf(net, scratch);
+        ok = ok && &renamed == &scratch && renamed.transition("t3") == 1 && renamed.transition("t2") == -1;
+        cout << (ok ? "[TEST 21] PASSED: Stale symbol tables are rebuilt."
+                    : "[TEST 21] FAILED: A stale symbol table was reused.") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 21: " << e.what() << endl;
+    }
+}
+
+void testWeightedIlp() {
+    cout << "\n[TEST 22] ILP deadlock rows with weighted inputs (tokenBound = weight)..." << endl;
+    try {
+        /*
+         * P (1 token) -(2)-> T, tokenBound = 2: T không bao giờ fire, {P=1} là deadlock.
+         * Thêm các mạng nhỏ sinh giả ngẫu nhiên (trọng số 1..2, bound 2): IlpCegar và Symbolic
+         * phải cùng kết luận, và marking ILP trả về phải reachable và chết.
+         */
+        vector<PetriNet> nets = {makeNet({"p"}, {1}, {"t"}, {{"p", "t", 2}})};
+        unsigned seed = 12345;
+        auto next = [&seed](unsigned range) {
+            seed = seed * 1103515245u + 12345u;
+            return (seed >> 16) % range;
+        };
+        for (int n = 0; n < 40; n++) {
+            vector<string> places = {"p0", "p1", "p2"}, transitions = {"t0", "t1"};
+            vector<int> m0;
+            for (int p = 0; p < 3; p++) m0.push_back(next(3));
+            vector<NetArc> arcs;
+            for (const string& t : transitions) {
+                int in = next(3), out = next(3);
+                arcs.push_back({places[in], t, (int)next(2) + 1});
+                if (next(2)) arcs.push_back({places[(in + 1) % 3], t, (int)next(2) + 1});
+                arcs.push_back({t, places[out], 1});
+            }
+            nets.push_back(makeNet(places, m0, transitions, arcs));
+        }
+
+        int disagreements = 0, deadlocks = 0;
+        for (const PetriNet& net : nets) {
+            SymbolicOptions options;
+            options.tokenBound = 2;
+            options.reordering = CUDD_REORDER_NONE;
+            SymbolicPetriNet symNet(net, options);
+            prepareSymbolic(symNet);
+            symNet.computeReachability();
+            DeadlockDetector ilp(net, symNet, DeadlockMethod::IlpCegar);
+            DeadlockDetector bdd(net, symNet, DeadlockMethod::Symbolic);
+            bool found = ilp.detectDeadlock();
+            if (found != bdd.detectDeadlock()) disagreements++;
+            if (found) {
+                deadlocks++;
+                vector<int> marking = ilp.getDeadlockMarking().tokens;
+                const CompiledNet& compiled = symNet.getCompiledNet();
+                bool deadAndReachable = symNet.contains(marking);
+                for (int t = 0; t < compiled.numTransitions(); t++) {
+                    bool enabled = true;
+                    for (const IncidenceEntry* e = compiled.preBegin(t); e != compiled.preEnd(t); ++e)
+                        if (marking[e->place] < e->weight) enabled = false;
+                    if (enabled) deadAndReachable = false;
+                }
+                if (!deadAndReachable) disagreements++;
+            }
+        }
+        bool ok = disagreements == 0 && deadlocks > 1;
+        cout << (ok ? "[TEST 22] PASSED: IlpCegar agrees with Symbolic on " + to_string(nets.size()) + " weighted nets."
+                    : "[TEST 22] FAILED: " + to_string(disagreements) + " weighted nets disagree.") << endl;
+    } catch (const exception& e) {
+        cerr << "Error in Test 22: " << e.what() << endl;
+    }
+}
+
 int main() {
     testLoadAndDetect();
     testManualDeadlock();
+    testSymbolicDeadlock();
+    testInvariants();
+    testImpliedPlaces();
+    testNetReduction();
+    testStreamingLoader();
+    testNetCache();
+    testGzipLoader();
+    testMultiPageLoader();
+    testPackedBFS();
+    testParallelBFS();
+    testSaturation();
+    testReachabilityStrategies();
+    testBinaryCounters();
+    testMddReachability();
+    testZddVsBdd();
+    testReachableStatesCache();
+    testInvariantRows();
+    testSeriesTransitionsAndSelfLoops();
+    testStaleSymbols();
+    testWeightedIlp();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include "variableOrder.h"
+#include <deque>
+#include <numeric>
+
+namespace {
+
+//các place mà transition t chạm tới (pre ∪ post), không trùng
+vector<vector<int>> transitionSupports(const CompiledNet& net) {
+    vector<vector<int>> support(net.numTransitions());
+    vector<int> stamp(net.numPlaces(), -1);
+    for (int t = 0; t < net.numTransitions(); t++) {
+        auto add = [&](const IncidenceEntry* b, const IncidenceEntry* e) {
+            for (; b != e; ++b)
+                if (stamp[b->place] != t) {
+                    stamp[b->place] = t;
+                    support[t].push_back(b->place);
+                }
+        };
+        add(net.preBegin(t), net.preEnd(t));
+        add(net.postBegin(t), net.postEnd(t));
+    }
+    return support;
+}
+
+//các transition chạm tới place p (consumer ∪ producer)
+vector<vector<int>> placeEdges(const CompiledNet& net, const vector<vector<int>>& support) {
+    vector<vector<int>> edges(net.numPlaces());
+    for (int t = 0; t < (int)support.size(); t++)
+        for (int p : support[t]) edges[p].push_back(t);
+    return edges;
+}
+
+vector<int> traversalOrder(const CompiledNet& net, bool depthFirst) {
+    vector<vector<int>> support = transitionSupports(net);
+    vector<vector<int>> edges = placeEdges(net, support);
+    int P = net.numPlaces();
+    vector<bool> seen(P, false), edgeDone(net.numTransitions(), false);
+    vector<int> order;
+    order.reserve(P);
+
+    for (int root = 0; root < P; root++) {
+        if (seen[root]) continue;
+        //deque: DFS lấy ở cuối, BFS lấy ở đầu
+        deque<int> work{root};
+        while (!work.empty()) {
+            int p;
+            if (depthFirst) { p = work.back(); work.pop_back(); }
+            else { p = work.front(); work.pop_front(); }
+            if (seen[p]) continue;
+            seen[p] = true;
+            order.push_back(p);
+            for (int t : edges[p]) {
+                if (edgeDone[t]) continue;
+                edgeDone[t] = true;
+                if (depthFirst) {
+                    //đẩy ngược để place khai báo trước được lấy ra trước
+                    for (auto it = support[t].rbegin(); it != support[t].rend(); ++it)
+                        if (!seen[*it]) work.push_back(*it);
+                } else {
+                    for (int q : support[t])
+                        if (!seen[q]) work.push_back(q);
+                }
+            }
+        }
+    }
+    return order;
+}
+
+vector<int> forceOrder(const CompiledNet& net) {
+    vector<vector<int>> support = transitionSupports(net);
+    vector<vector<int>> edges = placeEdges(net, support);
+    int P = net.numPlaces();
+
+    //khởi đầu từ thứ tự DFS: FORCE hội tụ về cực tiểu cục bộ nên điểm xuất phát tốt giúp nhiều
+    vector<int> order = traversalOrder(net, true);
+    vector<int> best = order;
+    long long bestSpan = orderSpan(net, order);
+
+    vector<double> pos(P), cog(support.size());
+    int maxIterations = 50;
+    for (int it = 0; it < maxIterations; it++) {
+        for (int k = 0; k < P; k++) pos[order[k]] = k;
+        for (size_t t = 0; t < support.size(); t++) {
+            if (support[t].empty()) continue;
+            double sum = 0;
+            for (int p : support[t]) sum += pos[p];
+            cog[t] = sum / support[t].size();
+        }
+        vector<double> target(P);
+        for (int p = 0; p < P; p++) {
+            if (edges[p].empty()) { target[p] = pos[p]; continue; }
+            double sum = 0;
+            for (int t : edges[p]) sum += cog[t];
+            target[p] = sum / edges[p].size();
+        }
+        stable_sort(order.begin(), order.end(), [&](int a, int b) { return target[a] < target[b]; });
+
+        long long span = orderSpan(net, order);
+        if (span >= bestSpan) break;
+        bestSpan = span;
+        best = order;
+    }
+    return best;
+}
+
+}
+
+const char* variableOrderName(VariableOrder order) {
+    switch (order) {
+        case VariableOrder::Declaration: return "declaration";
+        case VariableOrder::DFS: return "DFS";
+        case VariableOrder::BFS: return "BFS";
+        case VariableOrder::Force: return "FORCE";
+    }
+    return "?";
+}
+
+long long orderSpan(const CompiledNet& net, const vector<int>& order) {
+    vector<int> pos(net.numPlaces());
+    for (int k = 0; k < (int)order.size(); k++) pos[order[k]] = k;
+    long long span = 0;
+    for (const auto& sup : transitionSupports(net)) {
+        if (sup.empty()) continue;
+        int lo = pos[sup[0]], hi = pos[sup[0]];
+        for (int p : sup) { lo = min(lo, pos[p]); hi = max(hi, pos[p]); }
+        span += hi - lo;
+    }
+    return span;
+}
+
+vector<int> computePlaceOrder(const CompiledNet& net, VariableOrder order) {
+    switch (order) {
+        case VariableOrder::DFS: return traversalOrder(net, true);
+        case VariableOrder::BFS: return traversalOrder(net, false);
+        case VariableOrder::Force: return forceOrder(net);
+        case VariableOrder::Declaration: break;
+    }
+    vector<int> identity(net.numPlaces());
+    iota(identity.begin(), identity.end(), 0);
+    return identity;
+}
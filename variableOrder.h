@@ -0,0 +1,27 @@
+#ifndef VARIABLE_ORDER_H
+#define VARIABLE_ORDER_H
+
+#include "compiledNet.h"
+
+/*
+ * Heuristic tĩnh chọn thứ tự place cho các biến quyết định (BDD/ZDD/MDD),
+ * tính từ cấu trúc đồ thị place-transition.
+ *
+ * - Declaration: thứ tự khai báo trong file PNML.
+ * - DFS / BFS:   duyệt đồ thị vô hướng "place -- transition -- place" (2 place kề nhau khi cùng
+ *                chạm một transition), gốc lấy theo thứ tự khai báo; place gặp trước đứng trước.
+ * - Force:       thuật toán FORCE (Aloul, Markov, Sakallah 2003). Mỗi transition là một siêu cạnh
+ *                nối các place nó chạm tới; lặp: đặt mỗi place vào trung bình trọng tâm các siêu cạnh
+ *                của nó rồi sắp xếp lại, giữ thứ tự có tổng độ trải (span) nhỏ nhất.
+ */
+enum class VariableOrder { Declaration, DFS, BFS, Force };
+
+const char* variableOrderName(VariableOrder order);
+
+//order[k] = place đứng ở vị trí k
+vector<int> computePlaceOrder(const CompiledNet& net, VariableOrder order);
+
+//tổng span (vị trí max - min) của các transition theo thứ tự order, dùng để so sánh thứ tự
+long long orderSpan(const CompiledNet& net, const vector<int>& order);
+
+#endif
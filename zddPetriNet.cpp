@@ -0,0 +1,188 @@
+#include "zddPetriNet.h"
+#include "symbolicPetriNet.h"
+#include <iostream>
+#include <stdexcept>
+
+ZddPetriNet::ZddPetriNet(const PetriNet& petriNet, const ZddOptions& options)
+    : net(petriNet), compiled(petriNet), options(options) {
+    ZDD_ops = nullptr;
+    initialState = nullptr;
+    reachableStates = nullptr;
+    numPlaces = compiled.numPlaces();
+    numTransitions = compiled.numTransitions();
+    iterations = 0;
+}
+
+ZddPetriNet::~ZddPetriNet() {
+    if (ZDD_ops) {
+        if (initialState) Cudd_RecursiveDerefZdd(ZDD_ops, initialState);
+        if (reachableStates) Cudd_RecursiveDerefZdd(ZDD_ops, reachableStates);
+        Cudd_Quit(ZDD_ops);
+    }
+}
+
+void ZddPetriNet::initialize() {
+    ZDD_ops = Cudd_Init(0, numPlaces, CUDD_UNIQUE_SLOTS, CUDD_CACHE_SLOTS, 0);
+    if (!ZDD_ops) {
+        throw std::runtime_error("Failed to initialize CUDD");
+    }
+
+    // ZDD variable k belongs to the place at position k of the static order
+    vector<int> placeOrder = computePlaceOrder(compiled, options.order);
+    placeToVar.resize(numPlaces);
+    for (int k = 0; k < numPlaces; k++) placeToVar[placeOrder[k]] = k;
+
+    consumeOnly.assign(numTransitions, {});
+    consumeAndProduce.assign(numTransitions, {});
+    produceOnly.assign(numTransitions, {});
+    vector<int> role(numPlaces, 0); // bit 0: input, bit 1: output
+    for (int t = 0; t < numTransitions; t++) {
+        vector<int> touched;
+        for (const IncidenceEntry* e = compiled.preBegin(t); e != compiled.preEnd(t); ++e) {
+            if (!role[e->place]) touched.push_back(e->place);
+            role[e->place] |= 1;
+        }
+        for (const IncidenceEntry* e = compiled.postBegin(t); e != compiled.postEnd(t); ++e) {
+            if (!role[e->place]) touched.push_back(e->place);
+            role[e->place] |= 2;
+        }
+        for (int p : touched) {
+            if (role[p] == 1) consumeOnly[t].push_back(placeToVar[p]);
+            else if (role[p] == 3) consumeAndProduce[t].push_back(placeToVar[p]);
+            else produceOnly[t].push_back(placeToVar[p]);
+            role[p] = 0;
+        }
+    }
+
+    std::cout << "\n[ZDD] Initialized ZDD with " << numPlaces << " variables ("
+              << variableOrderName(options.order) << " place order)" << std::endl;
+    if (options.reordering != CUDD_REORDER_NONE) {
+        Cudd_AutodynEnableZdd(ZDD_ops, options.reordering);
+        std::cout << "[ZDD] Dynamic reordering enabled (" << reorderingName(options.reordering) << ")" << std::endl;
+    }
+}
+
+//family with the single set {places marked in marking}; referenced
+DdNode* ZddPetriNet::markingSet(const vector<int>& marking) {
+    DdNode* set = Cudd_ReadOne(ZDD_ops); // ZDD constant 1 = {∅}
+    Cudd_Ref(set);
+    for (int p = 0; p < numPlaces; p++) {
+        if (marking[p] <= 0) continue;
+        DdNode* temp = Cudd_zddChange(ZDD_ops, set, placeToVar[p]);
+        Cudd_Ref(temp);
+        Cudd_RecursiveDerefZdd(ZDD_ops, set);
+        set = temp;
+    }
+    return set;
+}
+
+void ZddPetriNet::encodeInitialMarking() {
+    initialState = markingSet(compiled.initialMarking());
+    std::cout << "[ZDD] Encoded initial marking" << std::endl;
+}
+
+/*
+ * Successor family of states under transition transIdx, built by restricting and
+ * toggling the variables of the places it touches. Returns a referenced ZDD.
+ */
+DdNode* ZddPetriNet::imageOf(int transIdx, DdNode* states) {
+    DdNode* result = states;
+    Cudd_Ref(result);
+
+    auto replace = [&](DdNode* next) {
+        Cudd_Ref(next);
+        Cudd_RecursiveDerefZdd(ZDD_ops, result);
+        result = next;
+    };
+
+    for (int v : consumeOnly[transIdx]) {
+        replace(Cudd_zddSubset1(ZDD_ops, result, v));
+    }
+    for (int v : consumeAndProduce[transIdx]) {
+        replace(Cudd_zddSubset1(ZDD_ops, result, v));
+        replace(Cudd_zddChange(ZDD_ops, result, v));
+    }
+    for (int v : produceOnly[transIdx]) {
+        DdNode* without = Cudd_zddSubset0(ZDD_ops, result, v);
+        Cudd_Ref(without);
+        DdNode* with = Cudd_zddSubset1(ZDD_ops, result, v);
+        Cudd_Ref(with);
+        DdNode* cleared = Cudd_zddUnion(ZDD_ops, without, with);
+        Cudd_Ref(cleared);
+        Cudd_RecursiveDerefZdd(ZDD_ops, without);
+        Cudd_RecursiveDerefZdd(ZDD_ops, with);
+        DdNode* marked = Cudd_zddChange(ZDD_ops, cleared, v);
+        Cudd_Ref(marked);
+        Cudd_RecursiveDerefZdd(ZDD_ops, cleared);
+        Cudd_RecursiveDerefZdd(ZDD_ops, result);
+        result = marked;
+    }
+    return result;
+}
+
+DdNode* ZddPetriNet::imageComputation(DdNode* states) {
+    DdNode* result = Cudd_ReadZero(ZDD_ops); // empty family
+    Cudd_Ref(result);
+    for (int t = 0; t < numTransitions; t++) {
+        DdNode* img = imageOf(t, states);
+        DdNode* temp = Cudd_zddUnion(ZDD_ops, result, img);
+        Cudd_Ref(temp);
+        Cudd_RecursiveDerefZdd(ZDD_ops, result);
+        Cudd_RecursiveDerefZdd(ZDD_ops, img);
+        result = temp;
+    }
+    return result;
+}
+
+void ZddPetriNet::computeReachability() {
+    std::cout << "[ZDD] Computing reachability (frontier)..." << std::endl;
+    if (reachableStates) Cudd_RecursiveDerefZdd(ZDD_ops, reachableStates);
+
+    reachableStates = initialState;
+    Cudd_Ref(reachableStates);
+    DdNode* frontier = initialState;
+    Cudd_Ref(frontier);
+
+    iterations = 0;
+    while (frontier != Cudd_ReadZero(ZDD_ops)) {
+        iterations++;
+        DdNode* img = imageComputation(frontier);
+        Cudd_RecursiveDerefZdd(ZDD_ops, frontier);
+
+        frontier = Cudd_zddDiff(ZDD_ops, img, reachableStates);
+        Cudd_Ref(frontier);
+        Cudd_RecursiveDerefZdd(ZDD_ops, img);
+
+        DdNode* temp = Cudd_zddUnion(ZDD_ops, reachableStates, frontier);
+        Cudd_Ref(temp);
+        Cudd_RecursiveDerefZdd(ZDD_ops, reachableStates);
+        reachableStates = temp;
+    }
+    Cudd_RecursiveDerefZdd(ZDD_ops, frontier);
+
+    std::cout << "[ZDD] Fixed point reached at iteration " << iterations << std::endl;
+}
+
+//marking (token counts, > 0 means marked) is in the reachable family
+bool ZddPetriNet::contains(const vector<int>& marking) {
+    if ((int)marking.size() != numPlaces || !reachableStates) return false;
+    DdNode* set = markingSet(marking);
+    DdNode* common = Cudd_zddIntersect(ZDD_ops, reachableStates, set);
+    Cudd_Ref(common);
+    bool result = common == set;
+    Cudd_RecursiveDerefZdd(ZDD_ops, common);
+    Cudd_RecursiveDerefZdd(ZDD_ops, set);
+    return result;
+}
+
+void ZddPetriNet::printResults() {
+    std::cout << "\n========== ZDD REACHABILITY ==========" << std::endl;
+    std::cout << "Number of places: " << numPlaces << std::endl;
+    std::cout << "Number of transitions: " << numTransitions << std::endl;
+    std::cout << "Number of reachable states: " << countStates() << std::endl;
+    std::cout << "ZDD nodes (reachable set): " << getReachableNodeCount() << std::endl;
+    std::cout << "Live ZDD nodes: " << Cudd_zddReadNodeCount(ZDD_ops)
+              << " | Peak nodes: " << Cudd_ReadPeakNodeCount(ZDD_ops) << std::endl;
+    std::cout << "Reorderings performed: " << Cudd_ReadReorderings(ZDD_ops) << std::endl;
+    std::cout << "======================================" << std::endl;
+}